@@ -11,13 +11,16 @@ countries.
 #include "Shaders.h"
 
 #include <MathUtils.h>
-#include <MemoryStream.h>
 #include <Models.h>
 #include <Vuforia/Tool.h>
 
 #include <android/asset_manager.h>
 
-bool GLESRenderer::init(AAssetManager* assetManager)
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+bool GLESRenderer::init(AAssetManager* assetManager, const std::string& cacheDirectory)
 {
     // Setup for Video Background rendering
     mVbShaderProgramID =
@@ -55,6 +58,28 @@ bool GLESRenderer::init(AAssetManager* assetManager)
     mTextureUniformColorColorHandle =
         glGetUniformLocation(mTextureUniformColorShaderProgramID, "uniformColor");
 
+    // Setup for model rendering
+    mModelShaderProgramID =
+        GLESUtils::createProgramFromBuffer(modelVertexShaderSrc, textureColorFragmentShaderSrc);
+    mModelVertexPositionHandle =
+        glGetAttribLocation(mModelShaderProgramID, "vertexPosition");
+    mModelTextureCoordHandle =
+        glGetAttribLocation(mModelShaderProgramID, "vertexTextureCoord");
+    mModelMvpMatrixHandle =
+        glGetUniformLocation(mModelShaderProgramID, "modelViewProjectionMatrix");
+    mModelTexSampler2DHandle =
+        glGetUniformLocation(mModelShaderProgramID, "texSampler2D");
+    mModelColorHandle =
+        glGetUniformLocation(mModelShaderProgramID, "uniformColor");
+    mModelPositionScaleHandle =
+        glGetUniformLocation(mModelShaderProgramID, "positionScale");
+    mModelPositionOffsetHandle =
+        glGetUniformLocation(mModelShaderProgramID, "positionOffset");
+    mModelTexCoordScaleHandle =
+        glGetUniformLocation(mModelShaderProgramID, "texCoordScale");
+    mModelTexCoordOffsetHandle =
+        glGetUniformLocation(mModelShaderProgramID, "texCoordOffset");
+
     // Setup for axis rendering
     mVertexColorShaderProgramID =
         GLESUtils::createProgramFromBuffer(vertexColorVertexShaderSrc, vertexColorFragmentShaderSrc);
@@ -67,33 +92,30 @@ bool GLESRenderer::init(AAssetManager* assetManager)
 
     mModelTargetGuideViewTextureUnit = -1;
 
-    std::vector<char> data; // for reading model files
+    mStateCache.invalidate();
+    mFrameCount = 0;
+
+    // Buffers of a previous GL context are gone with it, don't delete them
+    mAstronautBuffers = ModelBuffers();
+    mLanderBuffers = ModelBuffers();
+
+    ModelCache modelCache(cacheDirectory);
 
     // Load Astronaut model
     {
-        if (!readAsset(assetManager, "Astronaut.obj", data))
+        if (!loadModel(assetManager, modelCache, "Astronaut.obj", mAstronautBuffers))
         {
             return false;
         }
-        if (!loadObjModel(data, mAstronautVertexCount, mAstronautVertices, mAstronautTexCoords))
-        {
-            return false;
-        }
-        data.clear();
         mAstronautTextureUnit = -1;
     }
 
     // Load Lander model
     {
-        if (!readAsset(assetManager, "VikingLander.obj", data))
-        {
-            return false;
-        }
-        if (!loadObjModel(data, mLanderVertexCount, mLanderVertices, mLanderTexCoords))
+        if (!loadModel(assetManager, modelCache, "VikingLander.obj", mLanderBuffers))
         {
             return false;
         }
-        data.clear();
         mLanderTextureUnit = -1;
     }
 
@@ -118,6 +140,8 @@ void GLESRenderer::deinit()
         GLESUtils::destroyTexture(mLanderTextureUnit);
         mLanderTextureUnit = -1;
     }
+    destroyModelBuffers(mAstronautBuffers);
+    destroyModelBuffers(mLanderBuffers);
 }
 
 
@@ -133,23 +157,49 @@ void GLESRenderer::setLanderTexture(int width, int height, unsigned char* bytes)
 }
 
 
+void GLESRenderer::beginFrame()
+{
+    if (DEBUG_STATE_STATISTICS && mFrameCount > 0)
+    {
+        const auto& statistics = mStateCache.getStatistics();
+        LOG("Frame %d GL state changes: %d issued, %d filtered", mFrameCount,
+            statistics.issuedCalls, statistics.filteredCalls);
+    }
+    ++mFrameCount;
+
+    // Vuforia binds the video background texture while preparing the frame
+    mStateCache.invalidate();
+    mStateCache.resetStatistics();
+}
+
+
+void GLESRenderer::endFrame()
+{
+    // Goes through the state cache, so these calls count in the statistics of the frame
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
+    mStateCache.useProgram(0);
+    mStateCache.bindTexture(0, 0);
+    mStateCache.setDepthTestEnabled(false);
+    mStateCache.setCullFaceEnabled(false);
+    mStateCache.setBlendEnabled(false);
+}
+
+
 void GLESRenderer::renderVideoBackground(
     Vuforia::Matrix44F& projectionMatrix,
     const float* vertices, const float* textureCoordinates,
     const int numTriangles, const unsigned short* indices,
     int textureUnit)
 {
-    GLboolean depthTest = GL_FALSE;
-    GLboolean cullTest = GL_FALSE;
-
-    glGetBooleanv(GL_DEPTH_TEST, &depthTest);
-    glGetBooleanv(GL_CULL_FACE, &cullTest);
-
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    mStateCache.setDepthTestEnabled(false);
+    mStateCache.setCullFaceEnabled(false);
+    mStateCache.setBlendEnabled(false);
 
     // Load the shader and upload the vertex/texcoord/index data
-    glUseProgram(mVbShaderProgramID);
+    mStateCache.useProgram(mVbShaderProgramID);
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
     glVertexAttribPointer(static_cast<GLuint>(mVbVertexPositionHandle), 3, GL_FLOAT,
                           GL_FALSE, 0, vertices);
     glVertexAttribPointer(static_cast<GLuint>(mVbTextureCoordHandle), 2, GL_FLOAT,
@@ -173,12 +223,6 @@ void GLESRenderer::renderVideoBackground(
     glDisableVertexAttribArray(static_cast<GLuint>(mVbVertexPositionHandle));
     glDisableVertexAttribArray(static_cast<GLuint>(mVbTextureCoordHandle));
 
-    if(depthTest)
-        glEnable(GL_DEPTH_TEST);
-
-    if(cullTest)
-        glEnable(GL_CULL_FACE);
-
     GLESUtils::checkGlError("Render video background");
 }
 
@@ -200,14 +244,14 @@ void GLESRenderer::renderImageTarget(Vuforia::Matrix44F& projectionMatrix,
     MathUtils::multiplyMatrix(projectionMatrix, scaledModelViewMatrix, scaledModelViewProjectionMatrix);
 
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    mStateCache.setDepthTestEnabled(true);
+    mStateCache.setCullFaceEnabled(false);
+    mStateCache.setBlendEnabled(true);
+    mStateCache.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    float stateLineWidth;
-    glGetFloatv(GL_LINE_WIDTH, &stateLineWidth);
-
-    glUseProgram(mUniformColorShaderProgramID);
+    mStateCache.useProgram(mUniformColorShaderProgramID);
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
 
     glVertexAttribPointer(mUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_TRUE, 0,
                           (const GLvoid *) &squareVertices[0]);
@@ -225,7 +269,7 @@ void GLESRenderer::renderImageTarget(Vuforia::Matrix44F& projectionMatrix,
 
     // Draw solid outline
     glUniform4f(mUniformColorColorHandle, 1.0, 0.0, 0.0, 1.0);
-    glLineWidth(4.0f);
+    mStateCache.setLineWidth(4.0f);
     glDrawElements(GL_LINES, NUM_SQUARE_WIREFRAME_INDEX, GL_UNSIGNED_SHORT,
                    (const GLvoid *) &squareWireframeIndices[0]);
 
@@ -233,19 +277,12 @@ void GLESRenderer::renderImageTarget(Vuforia::Matrix44F& projectionMatrix,
 
     GLESUtils::checkGlError("Render Image Target");
 
-    glLineWidth(stateLineWidth);
-
-    glDisable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-
     Vuforia::Vec3F axis2cmSize = Vuforia::Vec3F(0.02f, 0.02f, 0.02f);
     renderAxis(projectionMatrix, modelViewMatrix, axis2cmSize, 4.0f);
 
     Vuforia::Matrix44F modelViewProjectionMatrix;
     MathUtils::multiplyMatrix(projectionMatrix, modelViewMatrix, modelViewProjectionMatrix);
-    renderModel(modelViewProjectionMatrix,
-        mAstronautVertexCount, mAstronautVertices.data(), mAstronautTexCoords.data(),
-        mAstronautTextureUnit);
+    renderModel(modelViewProjectionMatrix, mAstronautBuffers, mAstronautTextureUnit);
 }
 
 
@@ -256,9 +293,7 @@ void GLESRenderer::renderModelTarget(Vuforia::Matrix44F& projectionMatrix,
     Vuforia::Matrix44F modelViewProjectionMatrix;
     MathUtils::multiplyMatrix(projectionMatrix, modelViewMatrix, modelViewProjectionMatrix);
 
-    renderModel(modelViewProjectionMatrix,
-        mLanderVertexCount, mLanderVertices.data(), mLanderTexCoords.data(),
-        mLanderTextureUnit);
+    renderModel(modelViewProjectionMatrix, mLanderBuffers, mLanderTextureUnit);
 
     Vuforia::Vec3F axis10cmSize = Vuforia::Vec3F(0.1f, 0.1f, 0.1f);
     renderAxis(projectionMatrix, modelViewMatrix, axis10cmSize, 4.0f);
@@ -273,18 +308,20 @@ void GLESRenderer::renderModelTargetGuideView(Vuforia::Matrix44F& projectionMatr
     MathUtils::multiplyMatrix(projectionMatrix, modelViewMatrix, modelViewProjectionMatrix);
 
 
-    glDisable(GL_DEPTH_TEST);
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    glActiveTexture(GL_TEXTURE0);
+    mStateCache.setDepthTestEnabled(false);
+    mStateCache.setCullFaceEnabled(false);
+    mStateCache.setBlendEnabled(true);
+    mStateCache.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     if (mModelTargetGuideViewTextureUnit == -1)
     {
         mModelTargetGuideViewTextureUnit = GLESUtils::createTexture(image);
+        // Texture creation changes the texture bindings behind the cache
+        mStateCache.invalidate();
     }
-    glBindTexture(GL_TEXTURE_2D, mModelTargetGuideViewTextureUnit);
+    mStateCache.bindTexture(0, mModelTargetGuideViewTextureUnit);
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
 
     glEnableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
     glVertexAttribPointer(mTextureUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&squareVertices[0]);
@@ -292,7 +329,7 @@ void GLESRenderer::renderModelTargetGuideView(Vuforia::Matrix44F& projectionMatr
     glEnableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
     glVertexAttribPointer(mTextureUniformColorTextureCoordHandle, 2, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&squareTexCoords[0]);
 
-    glUseProgram(mTextureUniformColorShaderProgramID);
+    mStateCache.useProgram(mTextureUniformColorShaderProgramID);
     glUniformMatrix4fv(mTextureUniformColorMvpMatrixHandle, 1, GL_FALSE, (GLfloat*)modelViewProjectionMatrix.data);
     glUniform4f(mTextureUniformColorColorHandle, 1.0f, 1.0f, 1.0f, 0.7f);
     glUniform1i(mTextureUniformColorTexSampler2DHandle, 0); //texture unit, not handle
@@ -303,14 +340,8 @@ void GLESRenderer::renderModelTargetGuideView(Vuforia::Matrix44F& projectionMatr
     //disable input data structures
     glDisableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
     glDisableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glUseProgram(0);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
 
     GLESUtils::checkGlError("Render guide view");
-
-    glDisable(GL_BLEND);
-    glEnable(GL_DEPTH_TEST);
 }
 
 
@@ -322,6 +353,8 @@ void GLESRenderer::createTexture(int width, int height, unsigned char* bytes, in
         textureId = -1;
     }
     textureId = GLESUtils::createTexture(width, height, bytes);
+    // Texture creation and deletion change the texture bindings behind the cache
+    mStateCache.invalidate();
 }
 
 
@@ -337,8 +370,12 @@ void GLESRenderer::renderCube(const Vuforia::Matrix44F& projectionMatrix, const
 
     ///////////////////////////////////////////////////////////////
     // Render with const ambient diffuse light uniform color shader
-    glEnable(GL_DEPTH_TEST);
-    glUseProgram(mUniformColorShaderProgramID);
+    mStateCache.setDepthTestEnabled(true);
+    mStateCache.setCullFaceEnabled(false);
+    mStateCache.setBlendEnabled(false);
+    mStateCache.useProgram(mUniformColorShaderProgramID);
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
 
     glEnableVertexAttribArray(mUniformColorVertexPositionHandle);
 
@@ -352,8 +389,6 @@ void GLESRenderer::renderCube(const Vuforia::Matrix44F& projectionMatrix, const
 
     //disable input data structures
     glDisableVertexAttribArray(mUniformColorVertexPositionHandle);
-    glUseProgram(0);
-    glDisable(GL_DEPTH_TEST);
 
     GLESUtils::checkGlError("Render cube");
     ///////////////////////////////////////////////////////
@@ -372,8 +407,12 @@ void GLESRenderer::renderAxis(const Vuforia::Matrix44F& projectionMatrix, const
 
     ///////////////////////////////////////////////////////
     // Render with vertex color shader
-    glEnable(GL_DEPTH_TEST);
-    glUseProgram(mVertexColorShaderProgramID);
+    mStateCache.setDepthTestEnabled(true);
+    mStateCache.setCullFaceEnabled(false);
+    mStateCache.setBlendEnabled(false);
+    mStateCache.useProgram(mVertexColorShaderProgramID);
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
 
     glEnableVertexAttribArray(mVertexColorVertexPositionHandle);
     glVertexAttribPointer(mVertexColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0, (const GLvoid*)&axisVertices[0]);
@@ -384,20 +423,13 @@ void GLESRenderer::renderAxis(const Vuforia::Matrix44F& projectionMatrix, const
     glUniformMatrix4fv(mVertexColorMvpMatrixHandle, 1, GL_FALSE, (GLfloat*)modelViewProjectionMatrix.data);
 
     // Draw
-    float stateLineWidth;
-    glGetFloatv(GL_LINE_WIDTH, &stateLineWidth);
-
-    glLineWidth(lineWidth);
+    mStateCache.setLineWidth(lineWidth);
 
     glDrawElements(GL_LINES, NUM_AXIS_INDEX, GL_UNSIGNED_SHORT, (const GLvoid*)&axisIndices[0]);
 
     //disable input data structures
     glDisableVertexAttribArray(mVertexColorVertexPositionHandle);
     glDisableVertexAttribArray(mVertexColorColorHandle);
-    glUseProgram(0);
-    glDisable(GL_DEPTH_TEST);
-
-    glLineWidth(stateLineWidth);
 
     GLESUtils::checkGlError("Render axis");
     ///////////////////////////////////////////////////////
@@ -405,143 +437,194 @@ void GLESRenderer::renderAxis(const Vuforia::Matrix44F& projectionMatrix, const
 
 
 void GLESRenderer::renderModel(Vuforia::Matrix44F modelViewProjectionMatrix,
-    const int numVertices, const float* vertices, const float* textureCoordinates,
-    GLint textureId)
+    const ModelBuffers& buffers, GLint textureId)
 {
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CCW);
+    mStateCache.setDepthTestEnabled(true);
+    mStateCache.setCullFaceEnabled(true);
+    mStateCache.setCullFace(GL_BACK);
+    mStateCache.setFrontFace(GL_CCW);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    mStateCache.setBlendEnabled(true);
+    mStateCache.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    glUseProgram(mTextureUniformColorShaderProgramID);
+    mStateCache.useProgram(mModelShaderProgramID);
 
-    glEnableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glVertexAttribPointer(mTextureUniformColorVertexPositionHandle, 3, GL_FLOAT, GL_FALSE, 0,
-                          (const GLvoid *) vertices);
+    // Quantized attributes are normalized integers, decoded in the shader
+    glEnableVertexAttribArray(mModelVertexPositionHandle);
+    mStateCache.bindArrayBuffer(buffers.vertexBuffer);
+    glVertexAttribPointer(mModelVertexPositionHandle, 3, buffers.positionType,
+                          buffers.positionType != GL_FLOAT, 0, nullptr);
 
-    glEnableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
-    glVertexAttribPointer(mTextureUniformColorTextureCoordHandle, 2, GL_FLOAT, GL_FALSE, 0,
-                          (const GLvoid *) textureCoordinates);
+    glEnableVertexAttribArray(mModelTextureCoordHandle);
+    mStateCache.bindArrayBuffer(buffers.texCoordBuffer);
+    glVertexAttribPointer(mModelTextureCoordHandle, 2, buffers.texCoordType,
+                          buffers.texCoordType != GL_FLOAT, 0, nullptr);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    mStateCache.bindElementArrayBuffer(buffers.indexBuffer);
+    mStateCache.bindTexture(0, textureId);
 
-    glUniformMatrix4fv(mTextureUniformColorMvpMatrixHandle, 1, GL_FALSE,
+    glUniformMatrix4fv(mModelMvpMatrixHandle, 1, GL_FALSE,
                        (GLfloat *) modelViewProjectionMatrix.data);
-    glUniform4f(mTextureUniformColorColorHandle, 1.0f, 1.0f, 1.0f, 1.0f);
-    glUniform1i(mTextureUniformColorTexSampler2DHandle, 0); //texture unit, not handle
+    glUniform3fv(mModelPositionScaleHandle, 1, buffers.positionScale);
+    glUniform3fv(mModelPositionOffsetHandle, 1, buffers.positionOffset);
+    glUniform2fv(mModelTexCoordScaleHandle, 1, buffers.texCoordScale);
+    glUniform2fv(mModelTexCoordOffsetHandle, 1, buffers.texCoordOffset);
+    glUniform4f(mModelColorHandle, 1.0f, 1.0f, 1.0f, 1.0f);
+    glUniform1i(mModelTexSampler2DHandle, 0); //texture unit, not handle
 
     // Draw
-    glDrawArrays(GL_TRIANGLES, 0, numVertices);
+    glDrawElements(GL_TRIANGLES, buffers.numIndices, buffers.indexType, nullptr);
 
     //disable input data structures
-    glDisableVertexAttribArray(mTextureUniformColorTextureCoordHandle);
-    glDisableVertexAttribArray(mTextureUniformColorVertexPositionHandle);
-    glUseProgram(0);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisableVertexAttribArray(mModelTextureCoordHandle);
+    glDisableVertexAttribArray(mModelVertexPositionHandle);
 
     GLESUtils::checkGlError("Render model");
+}
+
 
-    glDisable(GL_BLEND);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
+void GLESRenderer::createModelBuffers(const ModelCache::Model& model, ModelBuffers& buffers)
+{
+    // Models are drawn every frame but never modified, uploading them once saves
+    // streaming the whole mesh from client memory on each draw call
+    bool quantized = (model.vertexFormat == ModelCache::VertexFormat::QUANTIZED);
+    size_t componentSize = quantized ? sizeof(uint16_t) : sizeof(float);
+    buffers.positionType = quantized ? GL_SHORT : GL_FLOAT;
+    buffers.texCoordType = quantized ? GL_UNSIGNED_SHORT : GL_FLOAT;
+    std::copy(model.positionScale, model.positionScale + 3, buffers.positionScale);
+    std::copy(model.positionOffset, model.positionOffset + 3, buffers.positionOffset);
+    std::copy(model.texCoordScale, model.texCoordScale + 2, buffers.texCoordScale);
+    std::copy(model.texCoordOffset, model.texCoordOffset + 2, buffers.texCoordOffset);
+
+    glGenBuffers(1, &buffers.vertexBuffer);
+    mStateCache.bindArrayBuffer(buffers.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, model.numVertices * 3 * componentSize, model.vertices, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &buffers.texCoordBuffer);
+    mStateCache.bindArrayBuffer(buffers.texCoordBuffer);
+    glBufferData(GL_ARRAY_BUFFER, model.numVertices * 2 * componentSize, model.texCoords, GL_STATIC_DRAW);
+
+    glGenBuffers(1, &buffers.indexBuffer);
+    mStateCache.bindElementArrayBuffer(buffers.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, model.numIndices * model.indexSize, model.indices, GL_STATIC_DRAW);
+    buffers.numIndices = model.numIndices;
+    buffers.indexType = (model.indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    mStateCache.bindArrayBuffer(0);
+    mStateCache.bindElementArrayBuffer(0);
+
+    GLESUtils::checkGlError("Create model buffers");
 }
 
 
-bool GLESRenderer::readAsset(AAssetManager* assetManager, const char* filename, std::vector<char>& data)
+void GLESRenderer::destroyModelBuffers(ModelBuffers& buffers)
 {
-    LOG("Reading asset %s", filename);
-    AAsset* asset = AAssetManager_open(assetManager, filename, AASSET_MODE_STREAMING);
+    GLuint bufferIds[] = { buffers.vertexBuffer, buffers.texCoordBuffer, buffers.indexBuffer };
+    // glDeleteBuffers silently ignores 0
+    glDeleteBuffers(3, bufferIds);
+    buffers = ModelBuffers();
+    // Deleting a bound buffer resets the binding behind the cache
+    mStateCache.invalidate();
+}
+
+
+bool GLESRenderer::loadModel(AAssetManager* assetManager, ModelCache& cache, const char* filename,
+                             ModelBuffers& buffers)
+{
+    LOG("Loading model %s", filename);
+    // In buffer mode the asset is mapped straight from the APK if it is stored
+    // uncompressed, which is the case for OBJ files (see noCompress in build.gradle)
+    std::unique_ptr<AAsset, decltype(&AAsset_close)> asset(
+        AAssetManager_open(assetManager, filename, AASSET_MODE_BUFFER), AAsset_close);
     if (asset == nullptr)
     {
         LOG("Error opening asset file %s", filename);
         return false;
     }
-    auto assetSize = AAsset_getLength(asset);
-    data.reserve(assetSize);
-    char buf[BUFSIZ];
-    int nb_read = 0;
-    while ((nb_read = AAsset_read(asset, buf, BUFSIZ)) > 0)
-    {
-        std::copy(&buf[0], &buf[BUFSIZ], std::back_inserter(data));
-    }
-    AAsset_close(asset);
-    if (nb_read < 0)
+    const char* data = static_cast<const char*>(AAsset_getBuffer(asset.get()));
+    if (data == nullptr)
     {
         LOG("Error reading asset file %s", filename);
         return false;
     }
-    return true;
-}
-
+    size_t size = static_cast<size_t>(AAsset_getLength(asset.get()));
 
-bool GLESRenderer::loadObjModel(const std::vector<char>& data, int& numVertices, std::vector<float>& vertices, std::vector<float>& texCoords)
-{
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-
-    std::string warn;
-    std::string err;
-
-    MemoryInputStream aFileDataStream(data.data(), data.size());
-    bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &aFileDataStream);
-    if (!ret || !err.empty())
+    // The flags are part of the key, so changing them invalidates cached models
+    uint32_t options = (OPTIMIZE_MODELS ? 1u : 0u) | (QUANTIZE_MODELS ? 2u : 0u);
+    uint64_t key = ModelCache::computeKey(data, size, options);
+    ModelCache::Model model;
+    if (cache.load(filename, key, model))
     {
-        LOG("Error loading model (%s)", err.c_str());
-        return false;
+        // Upload straight from the mapped cache file
+        createModelBuffers(model, buffers);
+        return true;
     }
-    if (!warn.empty())
+
+    ObjMesh mesh;
+    std::string error;
+    if (!ObjParser::parse(data, size, mesh, error))
     {
-        LOG("Warning loading model (%s)", warn.c_str());
+        LOG("Error loading model (%s)", error.c_str());
+        return false;
     }
 
-    numVertices = 0;
-    vertices.clear();
-    texCoords.clear();
-    // Loop over shapes
-    // s is the index into the shapes vector
-    // f is the index of the current face
-    // v is the index of the current vertex
-    for (size_t s = 0; s < shapes.size(); ++s)
+    if (OPTIMIZE_MODELS)
     {
-        // Loop over faces(polygon)
-        size_t index_offset = 0;
-        for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); ++f)
+        MeshOptimizer::CacheStatistics before =
+            MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size() / 3);
+        if (MeshOptimizer::optimize(mesh))
+        {
+            // Vertices no face uses are dropped, so the ATVR is relative to the new count
+            MeshOptimizer::CacheStatistics after =
+                MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertices.size() / 3);
+            LOG("Optimized model %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", filename,
+                before.acmr, after.acmr, before.atvr, after.atvr);
+        }
+        else
         {
-            int fv = shapes[s].mesh.num_face_vertices[f];
-            numVertices += fv;
-
-            // Loop over vertices in the face.
-            for (size_t v = 0; v < fv; ++v)
-            {
-                // access to vertex
-                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-                vertices.push_back(attrib.vertices[3 * idx.vertex_index + 0]);
-                vertices.push_back(attrib.vertices[3 * idx.vertex_index + 1]);
-                vertices.push_back(attrib.vertices[3 * idx.vertex_index + 2]);
-
-                // The model may not have texture coordinates for every vertex
-                // If a texture coordinate is missing we just set it to 0,0
-                // This may not be suitable for rendering some OBJ model files
-                if (idx.texcoord_index < 0)
-                {
-                    texCoords.push_back(0.f);
-                    texCoords.push_back(0.f);
-                }
-                else
-                {
-                    texCoords.push_back(attrib.texcoords[2 * idx.texcoord_index + 0]);
-                    texCoords.push_back(attrib.texcoords[2 * idx.texcoord_index + 1]);
-                }
-            }
-            index_offset += fv;
+            LOG("Model %s keeps its original order", filename);
         }
     }
+
+    size_t numVertices = mesh.vertices.size() / 3;
+    model.numVertices = static_cast<int>(numVertices);
+    model.vertexFormat = ModelCache::VertexFormat::FLOAT;
+    model.vertices = mesh.vertices.data();
+    model.texCoords = mesh.texCoords.data();
+
+    QuantizedMesh quantizedMesh;
+    if (QUANTIZE_MODELS)
+    {
+        MeshQuantizer::quantize(mesh, quantizedMesh);
+        MeshQuantizer::ErrorStatistics error = MeshQuantizer::measureError(mesh, quantizedMesh);
+        LOG("Quantized model %s: position error max %g (%g of size) rms %g, texture coordinate error max %g",
+            filename, error.maxPositionError, error.relativePositionError, error.rmsPositionError,
+            error.maxTexCoordError);
+
+        model.vertexFormat = ModelCache::VertexFormat::QUANTIZED;
+        model.vertices = quantizedMesh.vertices.data();
+        model.texCoords = quantizedMesh.texCoords.data();
+        std::copy(quantizedMesh.positionScale, quantizedMesh.positionScale + 3, model.positionScale);
+        std::copy(quantizedMesh.positionOffset, quantizedMesh.positionOffset + 3, model.positionOffset);
+        std::copy(quantizedMesh.texCoordScale, quantizedMesh.texCoordScale + 2, model.texCoordScale);
+        std::copy(quantizedMesh.texCoordOffset, quantizedMesh.texCoordOffset + 2, model.texCoordOffset);
+    }
+    model.numIndices = static_cast<int>(mesh.indices.size());
+    model.indexSize = sizeof(uint32_t);
+    model.indices = mesh.indices.data();
+
+    // Halve the index buffer if 16 bits can address every vertex
+    std::vector<uint16_t> shortIndices;
+    if (numVertices <= std::numeric_limits<uint16_t>::max() + 1)
+    {
+        shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+        model.indexSize = sizeof(uint16_t);
+        model.indices = shortIndices.data();
+    }
+    if (cache.isEnabled() && !cache.store(filename, key, model))
+    {
+        LOG("Model %s could not be cached", filename);
+    }
+    createModelBuffers(model, buffers);
     return true;
 }
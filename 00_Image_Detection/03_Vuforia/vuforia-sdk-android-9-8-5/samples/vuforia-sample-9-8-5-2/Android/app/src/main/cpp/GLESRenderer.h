@@ -12,12 +12,18 @@ countries.
 #include <GLES3/gl31.h>
 #include <GLES3/gl3ext.h>
 
-#include <tiny_obj_loader.h>
+#include "GLESStateCache.h"
+
+#include <MeshOptimizer.h>
+#include <MeshQuantizer.h>
+#include <ModelCache.h>
+#include <ObjParser.h>
 
 #include <Vuforia/Image.h>
 #include <Vuforia/Matrices.h>
 #include <Vuforia/Vectors.h>
 
+#include <string>
 #include <vector>
 
 
@@ -26,13 +32,34 @@ class GLESRenderer
 {
 public:
     /// Initialize the renderer ready for use
-    bool init(AAssetManager* assetManager);
+    /*
+    * Parsed models are cached in cacheDirectory, pass an empty string to always parse them
+    */
+    bool init(AAssetManager* assetManager, const std::string& cacheDirectory);
     /// Clean up objects created during rendering
     void deinit();
 
     void setAstronautTexture(int width, int height, unsigned char* bytes);
     void setLanderTexture(int width, int height, unsigned char* bytes);
 
+    /// Prepare for rendering a new frame
+    /*
+    * Must be called after Vuforia has updated the video background texture
+    * and before any other render call of the frame
+    */
+    void beginFrame();
+
+    /// Put the GL state back to its defaults at the end of the frame
+    /*
+    * Must be called after the last render call of the frame and before
+    * Vuforia finishes the frame, so the engine's rendering sees no buffers,
+    * program or texture of the sample bound.
+    */
+    void endFrame();
+
+    /// Return the GL state change statistics of the current frame
+    const GLESStateCache::Statistics& getStateStatistics() const { return mStateCache.getStatistics(); }
+
     /// Render the video background
     void renderVideoBackground(Vuforia::Matrix44F& projectionMatrix,
                                const float* vertices, const float* textureCoordinates,
@@ -58,6 +85,26 @@ public:
                                     Vuforia::Matrix44F& modelViewMatrix,
                                     const Vuforia::Image* Image);
 
+private: // types
+    /// GL buffers holding the indexed geometry of a model
+    struct ModelBuffers
+    {
+        GLuint vertexBuffer = 0;
+        GLuint texCoordBuffer = 0;
+        GLuint indexBuffer = 0;
+        int numIndices = 0;
+        GLenum indexType = GL_UNSIGNED_INT;
+
+        /// GL_FLOAT, or GL_SHORT / GL_UNSIGNED_SHORT for normalized quantized attributes
+        GLenum positionType = GL_FLOAT;
+        GLenum texCoordType = GL_FLOAT;
+        /// Decoding passed to the model shader, value = attribute * scale + offset
+        float positionScale[3] = { 1.f, 1.f, 1.f };
+        float positionOffset[3] = { 0.f, 0.f, 0.f };
+        float texCoordScale[2] = { 1.f, 1.f };
+        float texCoordOffset[2] = { 0.f, 0.f };
+    };
+
 private: // methods
     /// Attempt to create a texture from bytes
     void createTexture(int width, int height, unsigned char* bytes, int& textureId);
@@ -86,21 +133,43 @@ private: // methods
                     float lineWidth = 2.0f);
 
     /// Render a v3d model
+    /*
+    * buffers are the GL buffers created by createModelBuffers
+    */
     void renderModel(Vuforia::Matrix44F modelViewProjectionMatrix,
-                     const int numVertices, const float* vertices, const float* textureCoordinates,
-                     GLint textureId);
+                     const ModelBuffers& buffers, GLint textureId);
 
-    /// Read an asset file into a byte vector
-    bool readAsset(AAssetManager* assetManager, const char* filename, std::vector<char>& data);
+    /// Upload the geometry of a model into static GL buffers
+    void createModelBuffers(const ModelCache::Model& model, ModelBuffers& buffers);
 
-    /// Load a model from an OBJ file
+    /// Delete GL buffers created by createModelBuffers
+    void destroyModelBuffers(ModelBuffers& buffers);
+
+    /// Load a model from an OBJ asset, or its cached geometry, into static GL buffers
     /*
-    * The model is input as the data array, the vertex and texture coordinate
-    * vectors are populated by this method as it reads the input.
+    * The asset is accessed in place through AAsset_getBuffer and parsed by ObjParser,
+    * then optimized by MeshOptimizer if OPTIMIZE_MODELS is set and quantized by
+    * MeshQuantizer if QUANTIZE_MODELS is set
     */
-    bool loadObjModel(const std::vector<char>& data, int& numVertices, std::vector<float>& vertices, std::vector<float>& texCoords);
+    bool loadModel(AAssetManager* assetManager, ModelCache& cache, const char* filename,
+                   ModelBuffers& buffers);
 
 private: // data members
+    /// Enable this flag to log the GL state change statistics of every frame
+    static const bool DEBUG_STATE_STATISTICS = false;
+
+    /// Reorder parsed models for the vertex cache and overdraw before caching them
+    static const bool OPTIMIZE_MODELS = true;
+
+    /// Store model vertex attributes as 16-bit integers, halving their size
+    /*
+    * Opt-in: quantization is lossy, the error is logged when a model is loaded.
+    */
+    static const bool QUANTIZE_MODELS = false;
+
+    // Shadow copy of the GL state, filters redundant state changes
+    GLESStateCache mStateCache;
+    int mFrameCount = 0;
 
     // For video background rendering
     unsigned int mVbShaderProgramID     = 0;
@@ -124,20 +193,29 @@ private: // data members
     GLint mTextureUniformColorColorHandle               = 0;
     int mModelTargetGuideViewTextureUnit = -1;
 
+    // For model rendering, uses the texture color fragment shader
+    unsigned int mModelShaderProgramID      = 0;
+    GLint mModelVertexPositionHandle        = 0;
+    GLint mModelTextureCoordHandle          = 0;
+    GLint mModelMvpMatrixHandle             = 0;
+    GLint mModelTexSampler2DHandle          = 0;
+    GLint mModelColorHandle                 = 0;
+    GLint mModelPositionScaleHandle         = 0;
+    GLint mModelPositionOffsetHandle        = 0;
+    GLint mModelTexCoordScaleHandle         = 0;
+    GLint mModelTexCoordOffsetHandle        = 0;
+
     // For axis rendering
     unsigned int mVertexColorShaderProgramID    = 0;
     GLint mVertexColorVertexPositionHandle      = 0;
     GLint mVertexColorColorHandle               = 0;
     GLint mVertexColorMvpMatrixHandle           = 0;
 
-    int mAstronautVertexCount;
-    std::vector<float> mAstronautVertices;
-    std::vector<float> mAstronautTexCoords;
+    // Model geometry lives in static GL buffers, uploaded once at init
+    ModelBuffers mAstronautBuffers;
     int mAstronautTextureUnit = -1;
 
-    int mLanderVertexCount;
-    std::vector<float> mLanderVertices;
-    std::vector<float> mLanderTexCoords;
+    ModelBuffers mLanderBuffers;
     int mLanderTextureUnit = -1;
 };
 
@@ -0,0 +1,199 @@
+/*===============================================================================
+Copyright (c) 2020 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "GLESStateCache.h"
+
+
+void
+GLESStateCache::invalidate()
+{
+    for (int i = 0; i < NUM_CAPABILITIES; ++i)
+    {
+        mCapabilityKnown[i] = false;
+    }
+    for (int i = 0; i < NUM_TEXTURE_UNITS; ++i)
+    {
+        mTextureKnown[i] = false;
+    }
+    mBlendFuncKnown = false;
+    mCullFaceKnown = false;
+    mFrontFaceKnown = false;
+    mLineWidthKnown = false;
+    mProgramKnown = false;
+    mActiveTextureUnitKnown = false;
+    mArrayBufferKnown = false;
+    mElementArrayBufferKnown = false;
+}
+
+
+void
+GLESStateCache::setDepthTestEnabled(bool enabled)
+{
+    setCapability(GL_DEPTH_TEST, DEPTH_TEST_SLOT, enabled);
+}
+
+
+void
+GLESStateCache::setCullFaceEnabled(bool enabled)
+{
+    setCapability(GL_CULL_FACE, CULL_FACE_SLOT, enabled);
+}
+
+
+void
+GLESStateCache::setBlendEnabled(bool enabled)
+{
+    setCapability(GL_BLEND, BLEND_SLOT, enabled);
+}
+
+
+void
+GLESStateCache::setBlendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+    if (update(mBlendFuncKnown,
+               mBlendSourceFactor == sourceFactor && mBlendDestinationFactor == destinationFactor))
+    {
+        glBlendFunc(sourceFactor, destinationFactor);
+        mBlendFuncKnown = true;
+        mBlendSourceFactor = sourceFactor;
+        mBlendDestinationFactor = destinationFactor;
+    }
+}
+
+
+void
+GLESStateCache::setCullFace(GLenum mode)
+{
+    if (update(mCullFaceKnown, mCullFace == mode))
+    {
+        glCullFace(mode);
+        mCullFaceKnown = true;
+        mCullFace = mode;
+    }
+}
+
+
+void
+GLESStateCache::setFrontFace(GLenum mode)
+{
+    if (update(mFrontFaceKnown, mFrontFace == mode))
+    {
+        glFrontFace(mode);
+        mFrontFaceKnown = true;
+        mFrontFace = mode;
+    }
+}
+
+
+void
+GLESStateCache::setLineWidth(GLfloat width)
+{
+    if (update(mLineWidthKnown, mLineWidth == width))
+    {
+        glLineWidth(width);
+        mLineWidthKnown = true;
+        mLineWidth = width;
+    }
+}
+
+
+void
+GLESStateCache::useProgram(GLuint program)
+{
+    if (update(mProgramKnown, mProgram == program))
+    {
+        glUseProgram(program);
+        mProgramKnown = true;
+        mProgram = program;
+    }
+}
+
+
+void
+GLESStateCache::bindTexture(GLuint unit, GLuint textureId)
+{
+    if (unit >= NUM_TEXTURE_UNITS)
+    {
+        // Not tracked, always issue
+        mActiveTextureUnitKnown = false;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        mStatistics.issuedCalls += 2;
+        return;
+    }
+
+    if (!update(mTextureKnown[unit], mTexture[unit] == textureId))
+    {
+        return;
+    }
+
+    if (update(mActiveTextureUnitKnown, mActiveTextureUnit == unit))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        mActiveTextureUnitKnown = true;
+        mActiveTextureUnit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    mTextureKnown[unit] = true;
+    mTexture[unit] = textureId;
+}
+
+
+void
+GLESStateCache::bindArrayBuffer(GLuint bufferId)
+{
+    if (update(mArrayBufferKnown, mArrayBuffer == bufferId))
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, bufferId);
+        mArrayBufferKnown = true;
+        mArrayBuffer = bufferId;
+    }
+}
+
+
+void
+GLESStateCache::bindElementArrayBuffer(GLuint bufferId)
+{
+    if (update(mElementArrayBufferKnown, mElementArrayBuffer == bufferId))
+    {
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferId);
+        mElementArrayBufferKnown = true;
+        mElementArrayBuffer = bufferId;
+    }
+}
+
+
+bool
+GLESStateCache::update(bool known, bool unchanged)
+{
+    if (known && unchanged)
+    {
+        ++mStatistics.filteredCalls;
+        return false;
+    }
+    ++mStatistics.issuedCalls;
+    return true;
+}
+
+
+void
+GLESStateCache::setCapability(GLenum capability, int slot, bool enabled)
+{
+    if (update(mCapabilityKnown[slot], mCapabilityEnabled[slot] == enabled))
+    {
+        if (enabled)
+        {
+            glEnable(capability);
+        }
+        else
+        {
+            glDisable(capability);
+        }
+        mCapabilityKnown[slot] = true;
+        mCapabilityEnabled[slot] = enabled;
+    }
+}
@@ -0,0 +1,127 @@
+/*===============================================================================
+Copyright (c) 2020 PTC Inc. All Rights Reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef _VUFORIA_GLESSTATECACHE_H_
+#define _VUFORIA_GLESSTATECACHE_H_
+
+#include <GLES3/gl31.h>
+
+
+/// Shadow copy of the OpenGLES state set by the sample renderer
+/**
+ * Every setter compares the requested value with the last value set through
+ * the cache and skips the GL call if nothing would change. GL code outside the
+ * cache (Vuforia updating the video background texture, texture creation in
+ * GLESUtils) leaves the shadow copy stale, so the cache must be invalidated
+ * after such code has run. After invalidate() the next call to every setter is
+ * issued to GL.
+ */
+class GLESStateCache
+{
+public:
+    /// Number of setter calls sent to GL and dropped as redundant
+    struct Statistics
+    {
+        int issuedCalls = 0;
+        int filteredCalls = 0;
+    };
+
+    /// Forget all cached state
+    void invalidate();
+
+    /// Return the statistics collected since the last reset
+    const Statistics& getStatistics() const { return mStatistics; }
+
+    /// Reset the collected statistics
+    void resetStatistics() { mStatistics = Statistics(); }
+
+    /// Enable or disable GL_DEPTH_TEST
+    void setDepthTestEnabled(bool enabled);
+
+    /// Enable or disable GL_CULL_FACE
+    void setCullFaceEnabled(bool enabled);
+
+    /// Enable or disable GL_BLEND
+    void setBlendEnabled(bool enabled);
+
+    /// Set the blending factors (glBlendFunc)
+    void setBlendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+    /// Set the culled faces (glCullFace)
+    void setCullFace(GLenum mode);
+
+    /// Set the front face winding (glFrontFace)
+    void setFrontFace(GLenum mode);
+
+    /// Set the rasterized line width (glLineWidth)
+    void setLineWidth(GLfloat width);
+
+    /// Make the program current (glUseProgram)
+    void useProgram(GLuint program);
+
+    /// Bind a 2D texture to the texture unit, unit is 0-based (i.e. not GL_TEXTURE0 + unit)
+    void bindTexture(GLuint unit, GLuint textureId);
+
+    /// Bind a vertex buffer to GL_ARRAY_BUFFER, 0 for drawing from client memory
+    void bindArrayBuffer(GLuint bufferId);
+
+    /// Bind an index buffer to GL_ELEMENT_ARRAY_BUFFER, 0 for drawing with indices from client memory
+    void bindElementArrayBuffer(GLuint bufferId);
+
+private: // methods
+    /// Record the outcome of one setter call, return true if the GL call must be issued
+    bool update(bool known, bool unchanged);
+
+    /// Enable or disable a capability tracked in the given slot
+    void setCapability(GLenum capability, int slot, bool enabled);
+
+private: // data members
+    static const int NUM_CAPABILITIES = 3;
+    static const int NUM_TEXTURE_UNITS = 8;
+
+    enum CapabilitySlot
+    {
+        DEPTH_TEST_SLOT = 0,
+        CULL_FACE_SLOT  = 1,
+        BLEND_SLOT      = 2,
+    };
+
+    bool mCapabilityKnown[NUM_CAPABILITIES] = {};
+    bool mCapabilityEnabled[NUM_CAPABILITIES] = {};
+
+    bool mBlendFuncKnown = false;
+    GLenum mBlendSourceFactor = GL_ONE;
+    GLenum mBlendDestinationFactor = GL_ZERO;
+
+    bool mCullFaceKnown = false;
+    GLenum mCullFace = GL_BACK;
+
+    bool mFrontFaceKnown = false;
+    GLenum mFrontFace = GL_CCW;
+
+    bool mLineWidthKnown = false;
+    GLfloat mLineWidth = 1.0f;
+
+    bool mProgramKnown = false;
+    GLuint mProgram = 0;
+
+    bool mActiveTextureUnitKnown = false;
+    GLuint mActiveTextureUnit = 0;
+
+    bool mTextureKnown[NUM_TEXTURE_UNITS] = {};
+    GLuint mTexture[NUM_TEXTURE_UNITS] = {};
+
+    bool mArrayBufferKnown = false;
+    GLuint mArrayBuffer = 0;
+
+    bool mElementArrayBufferKnown = false;
+    GLuint mElementArrayBuffer = 0;
+
+    Statistics mStatistics;
+};
+
+#endif //_VUFORIA_GLESSTATECACHE_H_
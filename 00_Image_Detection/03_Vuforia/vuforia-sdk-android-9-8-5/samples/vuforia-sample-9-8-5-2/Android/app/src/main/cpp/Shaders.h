@@ -77,6 +77,32 @@ static const char* textureColorFragmentShaderSrc = R"(
 )";
 
 
+/////////////////////////////////////////////////////////////////////////////////////////
+// model shader: texture color shader decoding quantized vertex attributes
+// use with textureColorFragmentShaderSrc
+/////////////////////////////////////////////////////////////////////////////////////////
+static const char* modelVertexShaderSrc = R"(
+    attribute vec3 vertexPosition;
+    attribute vec2 vertexTextureCoord;
+
+    uniform mat4 modelViewProjectionMatrix;
+    // Attributes are decoded as normalized value * scale + offset
+    uniform vec3 positionScale;
+    uniform vec3 positionOffset;
+    uniform vec2 texCoordScale;
+    uniform vec2 texCoordOffset;
+
+    varying vec2 texCoord;
+
+    void main()
+    {
+        vec3 position = vertexPosition * positionScale + positionOffset;
+        gl_Position = modelViewProjectionMatrix * vec4(position, 1.0);
+        texCoord = vertexTextureCoord * texCoordScale + texCoordOffset;
+    }
+)";
+
+
 /////////////////////////////////////////////////////////////////////////////////////////
 //uniform color shader: uniform color in frag shader
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +18,7 @@ countries.
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 
+#include <string>
 #include <vector>
 
 
@@ -175,12 +176,20 @@ Java_com_vuforia_engine_NativeSample_VuforiaActivity_cameraRestoreAutoFocus(
 JNIEXPORT void JNICALL
 Java_com_vuforia_engine_NativeSample_VuforiaActivity_initRendering(
         JNIEnv *env,
-        jobject /* this */)
+        jobject /* this */,
+        jstring cacheDirectory)
 {
     // Define clear color
     glClearColor(0.0f, 0.0f, 0.0f, Vuforia::requiresAlpha() ? 0.0f : 1.0f);
 
-    if (!gWrapperData.renderer.init(gWrapperData.assetManager))
+    const char* cacheDirectoryChars = env->GetStringUTFChars(cacheDirectory, nullptr);
+    std::string cacheDirectoryString(cacheDirectoryChars != nullptr ? cacheDirectoryChars : "");
+    if (cacheDirectoryChars != nullptr)
+    {
+        env->ReleaseStringUTFChars(cacheDirectory, cacheDirectoryChars);
+    }
+
+    if (!gWrapperData.renderer.init(gWrapperData.assetManager, cacheDirectoryString))
     {
         LOG("Error initialising rendering");
     }
@@ -244,6 +253,8 @@ Java_com_vuforia_engine_NativeSample_VuforiaActivity_renderFrame(
         // Set viewport for current view
         glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
+        gWrapperData.renderer.beginFrame();
+
         auto renderingPrimitives = controller.getRenderingPrimitives();
         Vuforia::Matrix44F vbProjectionMatrix = Vuforia::Tool::convert2GLMatrix(
             renderingPrimitives->getVideoBackgroundProjectionMatrix(Vuforia::VIEW_SINGULAR));
@@ -276,6 +287,8 @@ Java_com_vuforia_engine_NativeSample_VuforiaActivity_renderFrame(
         {
             gWrapperData.renderer.renderModelTargetGuideView(trackableProjection, trackableModelView, modelTargetGuideViewImage);
         }
+
+        gWrapperData.renderer.endFrame();
     }
 
     controller.finishRender(nullptr);
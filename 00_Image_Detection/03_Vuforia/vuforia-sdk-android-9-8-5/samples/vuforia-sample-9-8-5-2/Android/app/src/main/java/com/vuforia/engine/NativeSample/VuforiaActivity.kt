@@ -60,7 +60,7 @@ class VuforiaActivity : AppCompatActivity(), GLSurfaceView.Renderer, SurfaceHold
     external fun cameraPerformAutoFocus()
     external fun cameraRestoreAutoFocus()
 
-    external fun initRendering()
+    external fun initRendering(cacheDirectory : String)
     external fun setTextures(astronautWidth: Int, astronautHeight: Int, astronautBytes: ByteBuffer,
                              landerWidth: Int, landerHeight: Int, landerBytes: ByteBuffer)
     external fun deinitRendering()
@@ -238,7 +238,7 @@ class VuforiaActivity : AppCompatActivity(), GLSurfaceView.Renderer, SurfaceHold
 
     // GLSurfaceView.Renderer methods
     override fun onSurfaceCreated(unused: GL10, config: EGLConfig) {
-        initRendering()
+        initRendering(cacheDir.absolutePath)
     }
 
 
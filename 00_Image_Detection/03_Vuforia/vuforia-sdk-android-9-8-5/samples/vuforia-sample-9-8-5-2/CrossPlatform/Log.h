@@ -25,6 +25,9 @@ void LOG(const char* message, ...);
 
 #elif defined(__APPLE__) // iOS
 #   define LOG(...) do { printf(__VA_ARGS__); printf("\n"); } while (0)
+
+#else // Other platforms, e.g. host builds of the tests
+#   define LOG(...) do { printf(__VA_ARGS__); printf("\n"); } while (0)
 #endif
 
 #endif // __LOG_H__
@@ -0,0 +1,396 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    /// A cluster may be split while the cache miss ratio of its first part is
+    /// at most this factor above the ratio of the whole cluster
+    const float OVERDRAW_THRESHOLD = 1.05f;
+
+    const uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    /// FIFO post-transform cache simulation
+    /*
+    * Every miss advances the clock, so a vertex is still cached if fewer than
+    * cacheSize misses happened since it was inserted.
+    */
+    class VertexCache
+    {
+    public:
+        VertexCache(size_t numVertices, int cacheSize)
+            : mInsertTime(numVertices, 0),
+              mCacheSize(static_cast<uint32_t>(cacheSize)),
+              mTime(mCacheSize + 1)
+        {
+        }
+
+        /// Return 1 if vertex misses the cache, 0 if it hits
+        int access(uint32_t vertex)
+        {
+            if (mTime - mInsertTime[vertex] > mCacheSize)
+            {
+                mInsertTime[vertex] = mTime++;
+                return 1;
+            }
+            return 0;
+        }
+
+        /// Return the number of misses of a triangle
+        int accessTriangle(const uint32_t* triangle)
+        {
+            return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+        }
+
+        /// Evict all vertices
+        void flush()
+        {
+            mTime += mCacheSize + 1;
+        }
+
+    private:
+        std::vector<uint32_t> mInsertTime;
+        uint32_t mCacheSize;
+        uint32_t mTime;
+    };
+
+    /// Reorder triangles with Tipsify (Sander, Nehab, Barczak: Fast Triangle Reordering for Vertex Locality and Reduced Overdraw)
+    /*
+    * Triangles are emitted as fans around a vertex. The next fan is centered
+    * on a vertex of the last fan that will still be cached once all its
+    * remaining triangles are emitted, preferring the oldest such vertex.
+    */
+    void tipsify(const std::vector<uint32_t>& indices, size_t numVertices, int cacheSize,
+                 std::vector<uint32_t>& result)
+    {
+        size_t numTriangles = indices.size() / 3;
+
+        // Triangles using each vertex
+        std::vector<uint32_t> adjacencyOffsets(numVertices + 1, 0);
+        for (uint32_t index : indices)
+        {
+            ++adjacencyOffsets[index + 1];
+        }
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+        }
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        // Number of triangles not emitted yet per vertex
+        std::vector<uint32_t> liveTriangles(numVertices);
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            liveTriangles[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+        }
+
+        std::vector<uint32_t> cacheTime(numVertices, 0);
+        std::vector<uint8_t> emitted(numTriangles, 0);
+        std::vector<uint32_t> deadEnd;
+        std::vector<uint32_t> candidates;
+        deadEnd.reserve(indices.size());
+
+        const int64_t size = cacheSize;
+        uint32_t time = static_cast<uint32_t>(cacheSize) + 1;
+        size_t cursor = 0;
+
+        result.clear();
+        result.reserve(indices.size());
+
+        int64_t fanVertex = 0;
+        while (fanVertex >= 0)
+        {
+            candidates.clear();
+            uint32_t fanBegin = adjacencyOffsets[static_cast<size_t>(fanVertex)];
+            uint32_t fanEnd = adjacencyOffsets[static_cast<size_t>(fanVertex) + 1];
+            for (uint32_t i = fanBegin; i < fanEnd; ++i)
+            {
+                uint32_t triangle = adjacency[i];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    uint32_t vertex = indices[triangle * 3 + k];
+                    result.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    --liveTriangles[vertex];
+                    if (time - cacheTime[vertex] > static_cast<uint32_t>(cacheSize))
+                    {
+                        cacheTime[vertex] = time++;
+                    }
+                }
+                emitted[triangle] = 1;
+            }
+
+            // Prefer the candidate that entered the cache first among those
+            // that stay cached while their remaining triangles are emitted
+            int64_t next = -1;
+            int64_t bestPriority = -1;
+            for (uint32_t vertex : candidates)
+            {
+                if (liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+                int64_t age = static_cast<int64_t>(time - cacheTime[vertex]);
+                int64_t priority = (age + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= size) ? age : 0;
+                if (priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    next = vertex;
+                }
+            }
+
+            // Dead end, continue with a recently used vertex or the next vertex in input order
+            while (next < 0 && !deadEnd.empty())
+            {
+                uint32_t vertex = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[vertex] > 0)
+                {
+                    next = vertex;
+                }
+            }
+            while (next < 0 && cursor < numVertices)
+            {
+                if (liveTriangles[cursor] > 0)
+                {
+                    next = static_cast<int64_t>(cursor);
+                }
+                ++cursor;
+            }
+            fanVertex = next;
+        }
+    }
+
+    /// Sort clusters of triangles front to back for less overdraw
+    /*
+    * The triangle sequence is split where the cache starts over anyway (hard
+    * boundaries), and further where splitting costs little cache efficiency
+    * (soft boundaries). Clusters facing away from the center of the mesh are
+    * likely to occlude the others and are drawn first.
+    */
+    void sortClusters(const std::vector<uint32_t>& indices, const std::vector<float>& positions,
+                      int cacheSize, std::vector<uint32_t>& result)
+    {
+        size_t numVertices = positions.size() / 3;
+        size_t numTriangles = indices.size() / 3;
+        VertexCache cache(numVertices, cacheSize);
+
+        // Hard boundaries, triangles missing the cache on all vertices. The first
+        // cluster always starts at the first triangle, which may be degenerate
+        // and hit the cache on a repeated vertex.
+        std::vector<size_t> hardClusters(1, 0);
+        for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+        {
+            if (cache.accessTriangle(&indices[triangle * 3]) == 3 && triangle > 0)
+            {
+                hardClusters.push_back(triangle);
+            }
+        }
+        hardClusters.push_back(numTriangles);
+
+        // Soft boundaries
+        std::vector<size_t> clusters;
+        for (size_t i = 0; i + 1 < hardClusters.size(); ++i)
+        {
+            size_t begin = hardClusters[i];
+            size_t end = hardClusters[i + 1];
+
+            cache.flush();
+            int misses = 0;
+            for (size_t triangle = begin; triangle < end; ++triangle)
+            {
+                misses += cache.accessTriangle(&indices[triangle * 3]);
+            }
+            float threshold = OVERDRAW_THRESHOLD * static_cast<float>(misses) / static_cast<float>(end - begin);
+
+            cache.flush();
+            clusters.push_back(begin);
+            size_t clusterBegin = begin;
+            int clusterMisses = 0;
+            for (size_t triangle = begin; triangle + 1 < end; ++triangle)
+            {
+                clusterMisses += cache.accessTriangle(&indices[triangle * 3]);
+                if (static_cast<float>(clusterMisses) <= threshold * static_cast<float>(triangle + 1 - clusterBegin))
+                {
+                    clusterBegin = triangle + 1;
+                    clusters.push_back(clusterBegin);
+                    clusterMisses = 0;
+                    cache.flush();
+                }
+            }
+        }
+        clusters.push_back(numTriangles);
+
+        float meshCenter[3] = { 0.f, 0.f, 0.f };
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                meshCenter[k] += positions[i * 3 + k];
+            }
+        }
+        for (float& coordinate : meshCenter)
+        {
+            coordinate /= static_cast<float>(std::max<size_t>(numVertices, 1));
+        }
+
+        // Sort key: distance of the cluster's centroid from the mesh center along the cluster normal
+        size_t numClusters = clusters.size() - 1;
+        std::vector<float> sortKeys(numClusters);
+        for (size_t cluster = 0; cluster < numClusters; ++cluster)
+        {
+            float center[3] = { 0.f, 0.f, 0.f };
+            float normal[3] = { 0.f, 0.f, 0.f };
+            float totalArea = 0.f;
+            for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+            {
+                const float* p0 = &positions[indices[triangle * 3 + 0] * 3];
+                const float* p1 = &positions[indices[triangle * 3 + 1] * 3];
+                const float* p2 = &positions[indices[triangle * 3 + 2] * 3];
+                float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float n[3] = {
+                    e0[1] * e1[2] - e0[2] * e1[1],
+                    e0[2] * e1[0] - e0[0] * e1[2],
+                    e0[0] * e1[1] - e0[1] * e1[0],
+                };
+                float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    center[k] += (p0[k] + p1[k] + p2[k]) / 3.f * area;
+                    normal[k] += n[k];
+                }
+                totalArea += area;
+            }
+
+            float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            float key = 0.f;
+            if (totalArea > 0.f && normalLength > 0.f)
+            {
+                for (size_t k = 0; k < 3; ++k)
+                {
+                    key += (center[k] / totalArea - meshCenter[k]) * normal[k] / normalLength;
+                }
+            }
+            sortKeys[cluster] = key;
+        }
+
+        std::vector<size_t> order(numClusters);
+        for (size_t i = 0; i < numClusters; ++i)
+        {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(),
+                         [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        result.clear();
+        result.reserve(indices.size());
+        for (size_t cluster : order)
+        {
+            result.insert(result.end(), indices.begin() + static_cast<std::ptrdiff_t>(clusters[cluster] * 3),
+                          indices.begin() + static_cast<std::ptrdiff_t>(clusters[cluster + 1] * 3));
+        }
+    }
+
+    /// Renumber the vertices in the order of their first use
+    void optimizeVertexFetch(ObjMesh& mesh)
+    {
+        size_t numVertices = mesh.vertices.size() / 3;
+        std::vector<uint32_t> remap(numVertices, INVALID_INDEX);
+        std::vector<float> vertices;
+        std::vector<float> texCoords;
+        vertices.reserve(mesh.vertices.size());
+        texCoords.reserve(mesh.texCoords.size());
+
+        for (uint32_t& index : mesh.indices)
+        {
+            if (remap[index] == INVALID_INDEX)
+            {
+                remap[index] = static_cast<uint32_t>(vertices.size() / 3);
+                vertices.insert(vertices.end(), &mesh.vertices[index * 3], &mesh.vertices[index * 3] + 3);
+                texCoords.insert(texCoords.end(), &mesh.texCoords[index * 2], &mesh.texCoords[index * 2] + 2);
+            }
+            index = remap[index];
+        }
+        mesh.vertices.swap(vertices);
+        mesh.texCoords.swap(texCoords);
+    }
+}
+
+
+MeshOptimizer::CacheStatistics
+MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t numIndices,
+                                  size_t numVertices, int cacheSize)
+{
+    CacheStatistics statistics;
+    if (numIndices < 3 || numVertices == 0)
+    {
+        return statistics;
+    }
+
+    VertexCache cache(numVertices, cacheSize);
+    size_t misses = 0;
+    for (size_t i = 0; i + 2 < numIndices; i += 3)
+    {
+        misses += static_cast<size_t>(cache.accessTriangle(&indices[i]));
+    }
+    statistics.acmr = static_cast<float>(misses) / static_cast<float>(numIndices / 3);
+    statistics.atvr = static_cast<float>(misses) / static_cast<float>(numVertices);
+    return statistics;
+}
+
+
+bool
+MeshOptimizer::optimize(ObjMesh& mesh, int cacheSize)
+{
+    if (mesh.indices.empty())
+    {
+        return false;
+    }
+
+    std::vector<uint32_t> tipsified;
+    tipsify(mesh.indices, mesh.vertices.size() / 3, cacheSize, tipsified);
+    std::vector<uint32_t> indices;
+    sortClusters(tipsified, mesh.vertices, cacheSize, indices);
+
+    // The passes only reorder triangles, never render a mesh that lost some
+    if (tipsified.size() != mesh.indices.size() || indices.size() != mesh.indices.size())
+    {
+        return false;
+    }
+
+    // Meshes already in a good order can come out worse, e.g. after the
+    // overdraw pass splits them. Renumbering the vertices doesn't change the
+    // cache behavior, so compare before doing it.
+    size_t numVertices = mesh.vertices.size() / 3;
+    CacheStatistics before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), numVertices, cacheSize);
+    CacheStatistics after = analyzeVertexCache(indices.data(), indices.size(), numVertices, cacheSize);
+    if (after.acmr > before.acmr)
+    {
+        return false;
+    }
+
+    mesh.indices.swap(indices);
+    optimizeVertexFetch(mesh);
+    return true;
+}
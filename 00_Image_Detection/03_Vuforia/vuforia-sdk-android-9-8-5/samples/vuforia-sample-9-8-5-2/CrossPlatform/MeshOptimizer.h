@@ -0,0 +1,63 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+#include "ObjParser.h"
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// Load-time reordering of indexed triangle meshes for faster rendering
+/**
+ * Authoring tools emit triangles in an order that makes poor use of the GPU's
+ * post-transform vertex cache. optimize() runs three passes over the mesh:
+ *  - Tipsify (Sander et al. 2007) reorders the triangles for vertex cache
+ *    locality.
+ *  - The resulting triangle sequence is split into clusters which are sorted
+ *    so outward-facing parts of the mesh are drawn first, reducing overdraw
+ *    while keeping most of the cache locality.
+ *  - Vertices are renumbered in the order they are first used, so vertex
+ *    fetches walk the vertex buffers sequentially. Vertices no triangle uses
+ *    are dropped, so the vertex count may decrease.
+ *
+ * The triangles themselves are unchanged, only their order and the order of
+ * the vertices change. The order is still visible where triangles overlap at
+ * the same depth and when they are blended, as the models are: translucent
+ * texels are composited in draw order.
+ */
+class MeshOptimizer
+{
+public:
+    /// Vertex cache efficiency of a triangle order
+    struct CacheStatistics
+    {
+        /// Average cache miss ratio, vertex shader invocations per triangle (0.5 - 3)
+        float acmr = 0.f;
+        /// Average transformed to vertex ratio, vertex shader invocations per vertex (1 is ideal)
+        float atvr = 0.f;
+    };
+
+    /// Size of the simulated FIFO post-transform cache
+    static const int CACHE_SIZE = 16;
+
+    /// Simulate a FIFO vertex cache of cacheSize entries over the triangles of indices
+    static CacheStatistics analyzeVertexCache(const uint32_t* indices, size_t numIndices,
+                                              size_t numVertices, int cacheSize = CACHE_SIZE);
+
+    /// Reorder the triangles and vertices of mesh in place
+    /*
+    * Returns false and leaves mesh unchanged if it has no triangles, if the
+    * reordered triangles don't add up to the original count, or if the new
+    * order would make worse use of the vertex cache than the original one.
+    */
+    static bool optimize(ObjMesh& mesh, int cacheSize = CACHE_SIZE);
+};
+
+#endif // __MESH_OPTIMIZER_H__
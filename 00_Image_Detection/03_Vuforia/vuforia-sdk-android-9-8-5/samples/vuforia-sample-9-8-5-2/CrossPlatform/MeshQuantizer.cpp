@@ -0,0 +1,148 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "MeshQuantizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const float SNORM16_MAX = 32767.f;
+    const float UNORM16_MAX = 65535.f;
+
+    /// Compute the range of components of every stride floats, return false if there are none
+    bool getRange(const std::vector<float>& values, size_t stride, size_t component, float& minimum, float& maximum)
+    {
+        if (values.size() < stride)
+        {
+            return false;
+        }
+        minimum = std::numeric_limits<float>::max();
+        maximum = std::numeric_limits<float>::lowest();
+        for (size_t i = component; i < values.size(); i += stride)
+        {
+            minimum = std::min(minimum, values[i]);
+            maximum = std::max(maximum, values[i]);
+        }
+        return true;
+    }
+
+    /// Normalized value GL passes to the shader for an int16 attribute
+    inline float decodeSnorm16(int16_t value)
+    {
+        return std::max(static_cast<float>(value) / SNORM16_MAX, -1.f);
+    }
+
+    /// Normalized value GL passes to the shader for a uint16 attribute
+    inline float decodeUnorm16(uint16_t value)
+    {
+        return static_cast<float>(value) / UNORM16_MAX;
+    }
+}
+
+
+void
+MeshQuantizer::quantize(const ObjMesh& mesh, QuantizedMesh& result)
+{
+    result = QuantizedMesh();
+
+    // Positions map the bounding box onto [-1, 1] on each axis
+    result.vertices.resize(mesh.vertices.size());
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        float minimum = 0.f;
+        float maximum = 0.f;
+        if (!getRange(mesh.vertices, 3, axis, minimum, maximum))
+        {
+            break;
+        }
+        float halfExtent = (maximum - minimum) * 0.5f;
+        float center = minimum + halfExtent;
+        result.positionScale[axis] = halfExtent;
+        result.positionOffset[axis] = center;
+
+        // A flat axis decodes to the center for any value
+        float encodeScale = halfExtent > 0.f ? SNORM16_MAX / halfExtent : 0.f;
+        for (size_t i = axis; i < mesh.vertices.size(); i += 3)
+        {
+            float value = std::round((mesh.vertices[i] - center) * encodeScale);
+            result.vertices[i] = static_cast<int16_t>(std::min(std::max(value, -SNORM16_MAX), SNORM16_MAX));
+        }
+    }
+
+    // Texture coordinates map their range onto [0, 1], they may be outside [0, 1] for repeating textures
+    result.texCoords.resize(mesh.texCoords.size());
+    for (size_t axis = 0; axis < 2; ++axis)
+    {
+        float minimum = 0.f;
+        float maximum = 0.f;
+        if (!getRange(mesh.texCoords, 2, axis, minimum, maximum))
+        {
+            break;
+        }
+        float extent = maximum - minimum;
+        result.texCoordScale[axis] = extent;
+        result.texCoordOffset[axis] = minimum;
+
+        float encodeScale = extent > 0.f ? UNORM16_MAX / extent : 0.f;
+        for (size_t i = axis; i < mesh.texCoords.size(); i += 2)
+        {
+            float value = std::round((mesh.texCoords[i] - minimum) * encodeScale);
+            result.texCoords[i] = static_cast<uint16_t>(std::min(std::max(value, 0.f), UNORM16_MAX));
+        }
+    }
+}
+
+
+MeshQuantizer::ErrorStatistics
+MeshQuantizer::measureError(const ObjMesh& mesh, const QuantizedMesh& quantized)
+{
+    ErrorStatistics statistics;
+    size_t numVertices = mesh.vertices.size() / 3;
+    if (numVertices == 0)
+    {
+        return statistics;
+    }
+
+    // Decode the same way the vertex shader does
+    double sumSquaredError = 0.0;
+    float diagonalSquared = 0.f;
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        float extent = 2.f * quantized.positionScale[axis];
+        diagonalSquared += extent * extent;
+    }
+    for (size_t i = 0; i < numVertices; ++i)
+    {
+        float squaredError = 0.f;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            float decoded = decodeSnorm16(quantized.vertices[i * 3 + axis]) * quantized.positionScale[axis] +
+                quantized.positionOffset[axis];
+            float error = decoded - mesh.vertices[i * 3 + axis];
+            squaredError += error * error;
+        }
+        statistics.maxPositionError = std::max(statistics.maxPositionError, std::sqrt(squaredError));
+        sumSquaredError += squaredError;
+    }
+    statistics.rmsPositionError = static_cast<float>(std::sqrt(sumSquaredError / static_cast<double>(numVertices)));
+    if (diagonalSquared > 0.f)
+    {
+        statistics.relativePositionError = statistics.maxPositionError / std::sqrt(diagonalSquared);
+    }
+
+    for (size_t i = 0; i < mesh.texCoords.size(); ++i)
+    {
+        size_t axis = i % 2;
+        float decoded = decodeUnorm16(quantized.texCoords[i]) * quantized.texCoordScale[axis] +
+            quantized.texCoordOffset[axis];
+        statistics.maxTexCoordError = std::max(statistics.maxTexCoordError, std::fabs(decoded - mesh.texCoords[i]));
+    }
+    return statistics;
+}
@@ -0,0 +1,65 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MESH_QUANTIZER_H__
+#define __MESH_QUANTIZER_H__
+
+#include "ObjParser.h"
+
+#include <cstdint>
+#include <vector>
+
+
+/// Mesh vertex attributes stored as normalized 16-bit integers
+/**
+ * Each attribute is decoded as normalized value * scale + offset, where the
+ * normalized value is what GL passes to the shader for a normalized attribute
+ * (max(q / 32767, -1) for int16, q / 65535 for uint16).
+ */
+struct QuantizedMesh
+{
+    /// 3 int16 per vertex, relative to the center of the bounding box
+    std::vector<int16_t> vertices;
+    float positionScale[3] = { 1.f, 1.f, 1.f };
+    float positionOffset[3] = { 0.f, 0.f, 0.f };
+
+    /// 2 uint16 per vertex, relative to the range of the texture coordinates
+    std::vector<uint16_t> texCoords;
+    float texCoordScale[2] = { 1.f, 1.f };
+    float texCoordOffset[2] = { 0.f, 0.f };
+};
+
+
+/// Quantization of mesh vertex attributes to halve their memory and bandwidth
+/**
+ * Positions are stored as snorm16 relative to the bounding box and texture
+ * coordinates as unorm16 relative to their range, 10 instead of 20 bytes per
+ * vertex. The decoding scale and offset are passed to the vertex shader.
+ */
+class MeshQuantizer
+{
+public:
+    /// Difference between the original and the decoded attributes
+    struct ErrorStatistics
+    {
+        /// Position errors in model units
+        float maxPositionError = 0.f;
+        float rmsPositionError = 0.f;
+        /// Largest position error relative to the bounding box diagonal
+        float relativePositionError = 0.f;
+        /// Texture coordinate error in texture space ([0, 1] covers the texture)
+        float maxTexCoordError = 0.f;
+    };
+
+    /// Quantize the vertex attributes of mesh
+    static void quantize(const ObjMesh& mesh, QuantizedMesh& result);
+
+    /// Compare the attributes of mesh with the decoded attributes of quantized
+    static ErrorStatistics measureError(const ObjMesh& mesh, const QuantizedMesh& quantized);
+};
+
+#endif // __MESH_QUANTIZER_H__
@@ -0,0 +1,272 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "ModelCache.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /// Increment whenever the layout of the cache files changes
+    const uint32_t CACHE_VERSION = 4;
+
+    const char CACHE_MAGIC[4] = { 'V', 'M', 'D', 'L' };
+
+    /// Cache file layout: header, positions (3 components per vertex), texture coordinates
+    /// (2 components per vertex), padding to 4 bytes, 16 or 32-bit indices
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t numVertices;
+        uint32_t numIndices;
+        uint32_t indexSize;
+        uint32_t vertexFormat;
+        float positionScale[3];
+        float positionOffset[3];
+        float texCoordScale[2];
+        float texCoordOffset[2];
+    };
+    static_assert(sizeof(FileHeader) == 72, "Cache file header must be tightly packed");
+
+    /// Byte offsets of the parts of a cache file
+    struct FileLayout
+    {
+        size_t texCoordsOffset;
+        size_t paddingSize;
+        size_t indicesOffset;
+        size_t fileSize;
+    };
+
+    /// Return the size of one vertex attribute component, 0 for an unknown format
+    size_t getComponentSize(uint32_t vertexFormat)
+    {
+        switch (static_cast<ModelCache::VertexFormat>(vertexFormat))
+        {
+            case ModelCache::VertexFormat::FLOAT:
+                return sizeof(float);
+            case ModelCache::VertexFormat::QUANTIZED:
+                return sizeof(uint16_t);
+        }
+        return 0;
+    }
+
+    FileLayout getFileLayout(const FileHeader& header)
+    {
+        size_t componentSize = getComponentSize(header.vertexFormat);
+        size_t numVertices = header.numVertices;
+
+        FileLayout layout;
+        layout.texCoordsOffset = sizeof(FileHeader) + numVertices * 3 * componentSize;
+        size_t texCoordsEnd = layout.texCoordsOffset + numVertices * 2 * componentSize;
+        // Keep 32-bit indices aligned after 16-bit vertex attributes
+        layout.indicesOffset = (texCoordsEnd + 3) & ~static_cast<size_t>(3);
+        layout.paddingSize = layout.indicesOffset - texCoordsEnd;
+        layout.fileSize = layout.indicesOffset + static_cast<size_t>(header.numIndices) * header.indexSize;
+        return layout;
+    }
+
+    /// Return true if the indices form whole triangles of existing vertices
+    template <typename Index>
+    bool validateIndices(const void* indices, uint32_t numIndices, uint32_t numVertices)
+    {
+        if (numIndices % 3 != 0)
+        {
+            return false;
+        }
+        const auto* begin = static_cast<const Index*>(indices);
+        return std::all_of(begin, begin + numIndices,
+                           [numVertices](Index index) { return index < numVertices; });
+    }
+}
+
+
+ModelCache::ModelCache(const std::string& directory)
+    : mDirectory(directory)
+{
+}
+
+
+ModelCache::~ModelCache()
+{
+    unmap();
+}
+
+
+uint64_t
+ModelCache::computeKey(const char* source, size_t size, uint32_t options)
+{
+    // 64-bit FNV-1a over the source followed by the options
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char>(source[i]);
+        hash *= 1099511628211ULL;
+    }
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        hash ^= (options >> shift) & 0xFF;
+        hash *= 1099511628211ULL;
+    }
+    return hash ^ size;
+}
+
+
+bool
+ModelCache::load(const char* name, uint64_t key, Model& model)
+{
+    unmap();
+    if (mDirectory.empty())
+    {
+        return false;
+    }
+
+    std::string path = getPath(name);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        LOG("Error mapping model cache file %s", path.c_str());
+        return false;
+    }
+    mMapping = mapping;
+    mMappingSize = size;
+
+    const auto* header = static_cast<const FileHeader*>(mapping);
+    if (memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->version != CACHE_VERSION ||
+        header->key != key ||
+        (header->indexSize != sizeof(uint16_t) && header->indexSize != sizeof(uint32_t)) ||
+        getComponentSize(header->vertexFormat) == 0 ||
+        getFileLayout(*header).fileSize != size)
+    {
+        unmap();
+        return false;
+    }
+
+    // The indices go straight to glDrawElements, a corrupted file must not make the GPU read out of bounds
+    FileLayout layout = getFileLayout(*header);
+    const auto* bytes = static_cast<const char*>(mapping);
+    bool indicesValid = header->indexSize == sizeof(uint16_t) ?
+        validateIndices<uint16_t>(bytes + layout.indicesOffset, header->numIndices, header->numVertices) :
+        validateIndices<uint32_t>(bytes + layout.indicesOffset, header->numIndices, header->numVertices);
+    if (!indicesValid)
+    {
+        LOG("Invalid indices in model cache file %s", path.c_str());
+        unmap();
+        return false;
+    }
+
+    model.numVertices = static_cast<int>(header->numVertices);
+    model.vertexFormat = static_cast<VertexFormat>(header->vertexFormat);
+    model.vertices = header + 1;
+    model.texCoords = bytes + layout.texCoordsOffset;
+    memcpy(model.positionScale, header->positionScale, sizeof(model.positionScale));
+    memcpy(model.positionOffset, header->positionOffset, sizeof(model.positionOffset));
+    memcpy(model.texCoordScale, header->texCoordScale, sizeof(model.texCoordScale));
+    memcpy(model.texCoordOffset, header->texCoordOffset, sizeof(model.texCoordOffset));
+    model.numIndices = static_cast<int>(header->numIndices);
+    model.indexSize = static_cast<int>(header->indexSize);
+    model.indices = bytes + layout.indicesOffset;
+    return true;
+}
+
+
+bool
+ModelCache::store(const char* name, uint64_t key, const Model& model)
+{
+    if (mDirectory.empty())
+    {
+        return false;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.numVertices = static_cast<uint32_t>(model.numVertices);
+    header.numIndices = static_cast<uint32_t>(model.numIndices);
+    header.indexSize = static_cast<uint32_t>(model.indexSize);
+    header.vertexFormat = static_cast<uint32_t>(model.vertexFormat);
+    memcpy(header.positionScale, model.positionScale, sizeof(header.positionScale));
+    memcpy(header.positionOffset, model.positionOffset, sizeof(header.positionOffset));
+    memcpy(header.texCoordScale, model.texCoordScale, sizeof(header.texCoordScale));
+    memcpy(header.texCoordOffset, model.texCoordOffset, sizeof(header.texCoordOffset));
+    FileLayout layout = getFileLayout(header);
+
+    // Write to a temporary file and rename it so a partially written file is never loaded
+    std::string path = getPath(name);
+    std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        LOG("Error creating model cache file %s", tempPath.c_str());
+        return false;
+    }
+
+    size_t numVertices = static_cast<size_t>(model.numVertices);
+    size_t numIndices = static_cast<size_t>(model.numIndices);
+    size_t componentSize = getComponentSize(header.vertexFormat);
+    const char padding[4] = {};
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(model.vertices, componentSize, numVertices * 3, file) == numVertices * 3 &&
+        fwrite(model.texCoords, componentSize, numVertices * 2, file) == numVertices * 2 &&
+        fwrite(padding, 1, layout.paddingSize, file) == layout.paddingSize &&
+        fwrite(model.indices, static_cast<size_t>(model.indexSize), numIndices, file) == numIndices;
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(tempPath.c_str(), path.c_str()) != 0)
+    {
+        LOG("Error writing model cache file %s", path.c_str());
+        remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+std::string
+ModelCache::getPath(const char* name) const
+{
+    return mDirectory + "/" + name + ".cache";
+}
+
+
+void
+ModelCache::unmap()
+{
+    if (mMapping != nullptr)
+    {
+        munmap(mMapping, mMappingSize);
+        mMapping = nullptr;
+        mMappingSize = 0;
+    }
+}
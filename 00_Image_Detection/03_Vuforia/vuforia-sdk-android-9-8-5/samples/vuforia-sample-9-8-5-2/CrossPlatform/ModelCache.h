@@ -0,0 +1,106 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __MODEL_CACHE_H__
+#define __MODEL_CACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/// Binary on-disk cache of parsed model geometry
+/**
+ * Parsing a text model file is by far the most expensive step of loading it.
+ * After the first load the geometry is written to a versioned binary file in
+ * the cache directory, and later loads memory-map that file and hand out
+ * pointers directly into the mapping, ready to be uploaded to the GPU.
+ *
+ * Entries are keyed by a hash of the model source and of the options it was
+ * processed with, so a changed source file or option simply misses the cache
+ * and overwrites the stale entry.
+ */
+class ModelCache
+{
+public:
+    /// Storage of the vertex attributes of a model
+    enum class VertexFormat : uint32_t
+    {
+        /// float components
+        FLOAT       = 0,
+        /// int16 positions and uint16 texture coordinates, see QuantizedMesh
+        QUANTIZED   = 1,
+    };
+
+    /// Model geometry, either mapped from a cache file or to be stored in one
+    struct Model
+    {
+        int numVertices = 0;
+        VertexFormat vertexFormat = VertexFormat::FLOAT;
+        /// numVertices * 3 components
+        const void* vertices = nullptr;
+        /// numVertices * 2 components
+        const void* texCoords = nullptr;
+        /// Decoding of quantized attributes, value = normalized value * scale + offset
+        float positionScale[3] = { 1.f, 1.f, 1.f };
+        float positionOffset[3] = { 0.f, 0.f, 0.f };
+        float texCoordScale[2] = { 1.f, 1.f };
+        float texCoordOffset[2] = { 0.f, 0.f };
+        /// Number of indices, 3 per triangle
+        int numIndices = 0;
+        /// Size of one index in bytes, 2 or 4
+        int indexSize = sizeof(uint32_t);
+        const void* indices = nullptr;
+    };
+
+    /// Create a cache storing its files in directory, an empty directory disables the cache
+    explicit ModelCache(const std::string& directory);
+
+    /// Release the current mapping
+    ~ModelCache();
+
+    ModelCache(const ModelCache&) = delete;
+    ModelCache& operator=(const ModelCache&) = delete;
+
+    /// Return false if the cache was created with an empty directory
+    bool isEnabled() const { return !mDirectory.empty(); }
+
+    /// Compute the cache key of a model source file of size bytes
+    /*
+    * options identifies how the geometry was processed before it was stored,
+    * e.g. a set of flags, so geometry processed differently gets another key.
+    */
+    static uint64_t computeKey(const char* source, size_t size, uint32_t options);
+
+    /// Map the cached geometry of the model called name
+    /*
+    * Returns false if there is no entry for name, the entry was written for a
+    * different key or by a different version of the cache, or it is corrupted
+    * (e.g. truncated, or with indices of vertices it doesn't have).
+    * On success the pointers in model refer to the mapped file and stay valid
+    * until the next call to load() or the destruction of the cache.
+    */
+    bool load(const char* name, uint64_t key, Model& model);
+
+    /// Write the geometry of the model called name to the cache
+    bool store(const char* name, uint64_t key, const Model& model);
+
+private: // methods
+    /// Return the path of the cache file for the model called name
+    std::string getPath(const char* name) const;
+
+    /// Release the current mapping, if any
+    void unmap();
+
+private: // data members
+    std::string mDirectory;
+
+    void* mMapping = nullptr;
+    size_t mMappingSize = 0;
+};
+
+#endif // __MODEL_CACHE_H__
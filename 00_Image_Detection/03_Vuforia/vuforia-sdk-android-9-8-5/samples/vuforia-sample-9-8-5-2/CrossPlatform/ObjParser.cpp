@@ -0,0 +1,735 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#include "ObjParser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace
+{
+    /// Smallest amount of data worth parsing on a thread of its own
+    const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+    const uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+    enum CornerFlags : uint8_t
+    {
+        POSITION_RELATIVE   = 1,
+        TEXCOORD_RELATIVE   = 2,
+        TEXCOORD_MISSING    = 4,
+    };
+
+    /// One vertex of a face
+    /*
+    * While a chunk is parsed, relative indices are stored relative to the start
+    * of the chunk and flagged. Once all chunks are parsed they are resolved to
+    * absolute 0-based indices, with texCoord set to -1 if it is missing.
+    */
+    struct Corner
+    {
+        int position;
+        int texCoord;
+        uint8_t flags;
+    };
+
+    /// Part of the file parsed by one thread
+    struct Chunk
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+
+        std::vector<float> positions;
+        std::vector<float> texCoords;
+        std::vector<int> faceSizes;
+        std::vector<Corner> corners;
+        std::vector<Corner> triangles;
+
+        /// Number of positions and texture coordinates in all previous chunks
+        int positionOffset = 0;
+        int texCoordOffset = 0;
+
+        int numLines = 0;
+        /// Line of the first invalid face, 1-based within the chunk, 0 if there is none
+        int errorLine = 0;
+        bool indexOutOfRange = false;
+    };
+
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t';
+    }
+
+    inline bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline const char* skipSpace(const char* s, const char* end)
+    {
+        while (s != end && isSpace(*s))
+        {
+            ++s;
+        }
+        return s;
+    }
+
+    /// Return the first character after the line terminator following s
+    const char* skipLine(const char* s, const char* end)
+    {
+        while (s != end && *s != '\n' && *s != '\r')
+        {
+            ++s;
+        }
+        if (s != end)
+        {
+            s += (*s == '\r' && s + 1 != end && s[1] == '\n') ? 2 : 1;
+        }
+        return s;
+    }
+
+    /// Parse a number the way tinyobj's tryParseDouble does
+    /*
+    * The mantissa is accumulated digit by digit and scaled by powers of ten,
+    * so the result can differ from strtod in the last bit. It is replicated
+    * exactly to produce the same floats as tinyobj.
+    */
+    bool parseDouble(const char* s, const char* end, double& result)
+    {
+        if (s >= end)
+        {
+            return false;
+        }
+
+        double mantissa = 0.0;
+        int exponent = 0;
+        char sign = '+';
+        const char* curr = s;
+
+        if (*curr == '+' || *curr == '-')
+        {
+            sign = *curr;
+            ++curr;
+        }
+        else if (!isDigit(*curr))
+        {
+            return false;
+        }
+
+        // Integer part
+        int read = 0;
+        while (curr != end && isDigit(*curr))
+        {
+            mantissa *= 10;
+            mantissa += static_cast<int>(*curr - '0');
+            ++curr;
+            ++read;
+        }
+        if (read == 0)
+        {
+            return false;
+        }
+
+        // Fractional part
+        if (curr != end && *curr == '.')
+        {
+            static const double POW_LUT[] = {
+                1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
+            };
+            const int lutEntries = sizeof(POW_LUT) / sizeof(POW_LUT[0]);
+
+            ++curr;
+            read = 1;
+            while (curr != end && isDigit(*curr))
+            {
+                mantissa += static_cast<int>(*curr - '0') *
+                    (read < lutEntries ? POW_LUT[read] : std::pow(10.0, -read));
+                ++read;
+                ++curr;
+            }
+        }
+        else if (curr == end || (*curr != 'e' && *curr != 'E'))
+        {
+            curr = end;
+        }
+
+        // Exponent
+        if (curr != end && (*curr == 'e' || *curr == 'E'))
+        {
+            ++curr;
+            char exponentSign = '+';
+            if (curr != end && (*curr == '+' || *curr == '-'))
+            {
+                exponentSign = *curr;
+                ++curr;
+            }
+            else if (curr == end || !isDigit(*curr))
+            {
+                return false;
+            }
+
+            read = 0;
+            while (curr != end && isDigit(*curr))
+            {
+                exponent *= 10;
+                exponent += static_cast<int>(*curr - '0');
+                ++curr;
+                ++read;
+            }
+            exponent *= (exponentSign == '+' ? 1 : -1);
+            if (read == 0)
+            {
+                return false;
+            }
+        }
+
+        result = (sign == '+' ? 1 : -1) *
+            (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent) : mantissa);
+        return true;
+    }
+
+    /// Parse the next space separated number of the line, defaults to 0 if it is missing or invalid
+    float parseFloat(const char*& token, const char* end)
+    {
+        token = skipSpace(token, end);
+        const char* tokenEnd = token;
+        while (tokenEnd != end && !isSpace(*tokenEnd) && *tokenEnd != '\r')
+        {
+            ++tokenEnd;
+        }
+        double value = 0.0;
+        parseDouble(token, tokenEnd, value);
+        token = tokenEnd;
+        return static_cast<float>(value);
+    }
+
+    /// Parse an integer the way atoi does, 0 if there is none
+    int parseInt(const char* s, const char* end)
+    {
+        while (s != end && (isSpace(*s) || *s == '\v' || *s == '\f' || *s == '\r'))
+        {
+            ++s;
+        }
+        bool negative = false;
+        if (s != end && (*s == '+' || *s == '-'))
+        {
+            negative = (*s == '-');
+            ++s;
+        }
+        unsigned int value = 0;
+        while (s != end && isDigit(*s))
+        {
+            value = value * 10 + static_cast<unsigned int>(*s - '0');
+            ++s;
+        }
+        return static_cast<int>(negative ? 0u - value : value);
+    }
+
+    /// Skip the rest of the current face index, up to the next '/' or space
+    inline const char* skipIndex(const char* s, const char* end)
+    {
+        while (s != end && *s != '/' && !isSpace(*s) && *s != '\r')
+        {
+            ++s;
+        }
+        return s;
+    }
+
+    /// Convert a 1-based or negative relative OBJ index, 0 is invalid
+    inline bool fixIndex(int index, int count, int& result, bool& relative)
+    {
+        if (index > 0)
+        {
+            result = index - 1;
+            relative = false;
+            return true;
+        }
+        if (index < 0)
+        {
+            result = count + index;
+            relative = true;
+            return true;
+        }
+        return false;
+    }
+
+    /// Parse one v, v/vt, v//vn or v/vt/vn face vertex
+    bool parseCorner(const char*& token, const char* end, int numPositions, int numTexCoords, Corner& corner)
+    {
+        bool relative = false;
+        corner.flags = TEXCOORD_MISSING;
+        corner.texCoord = -1;
+        if (!fixIndex(parseInt(token, end), numPositions, corner.position, relative))
+        {
+            return false;
+        }
+        if (relative)
+        {
+            corner.flags |= POSITION_RELATIVE;
+        }
+
+        token = skipIndex(token, end);
+        if (token == end || *token != '/')
+        {
+            return true;
+        }
+        ++token;
+
+        // v//vn, the normal index is validated but not used
+        int unused = 0;
+        if (token != end && *token == '/')
+        {
+            ++token;
+            if (!fixIndex(parseInt(token, end), 0, unused, relative))
+            {
+                return false;
+            }
+            token = skipIndex(token, end);
+            return true;
+        }
+
+        // v/vt or v/vt/vn
+        if (!fixIndex(parseInt(token, end), numTexCoords, corner.texCoord, relative))
+        {
+            return false;
+        }
+        corner.flags = static_cast<uint8_t>((corner.flags & ~TEXCOORD_MISSING) | (relative ? TEXCOORD_RELATIVE : 0));
+
+        token = skipIndex(token, end);
+        if (token == end || *token != '/')
+        {
+            return true;
+        }
+        ++token;
+        if (!fixIndex(parseInt(token, end), 0, unused, relative))
+        {
+            return false;
+        }
+        token = skipIndex(token, end);
+        return true;
+    }
+
+    /// Parse one line without its terminator, return false if it is an invalid face
+    bool parseLine(Chunk& chunk, const char* token, const char* end)
+    {
+        token = skipSpace(token, end);
+        if (token == end || *token == '#')
+        {
+            return true;
+        }
+
+        size_t length = static_cast<size_t>(end - token);
+        if (token[0] == 'v' && length > 1 && isSpace(token[1]))
+        {
+            token += 2;
+            float x = parseFloat(token, end);
+            float y = parseFloat(token, end);
+            float z = parseFloat(token, end);
+            chunk.positions.push_back(x);
+            chunk.positions.push_back(y);
+            chunk.positions.push_back(z);
+        }
+        else if (token[0] == 'v' && length > 2 && token[1] == 't' && isSpace(token[2]))
+        {
+            token += 3;
+            float u = parseFloat(token, end);
+            float v = parseFloat(token, end);
+            chunk.texCoords.push_back(u);
+            chunk.texCoords.push_back(v);
+        }
+        else if (token[0] == 'f' && length > 1 && isSpace(token[1]))
+        {
+            token = skipSpace(token + 2, end);
+            int numPositions = static_cast<int>(chunk.positions.size() / 3);
+            int numTexCoords = static_cast<int>(chunk.texCoords.size() / 2);
+            int faceSize = 0;
+            while (token != end && *token != '\r')
+            {
+                Corner corner;
+                if (!parseCorner(token, end, numPositions, numTexCoords, corner))
+                {
+                    return false;
+                }
+                chunk.corners.push_back(corner);
+                ++faceSize;
+                while (token != end && (isSpace(*token) || *token == '\r'))
+                {
+                    ++token;
+                }
+            }
+            chunk.faceSizes.push_back(faceSize);
+        }
+        return true;
+    }
+
+    void parseChunk(Chunk& chunk)
+    {
+        const char* line = chunk.begin;
+        while (line != chunk.end)
+        {
+            const char* lineEnd = line;
+            while (lineEnd != chunk.end && *lineEnd != '\n' && *lineEnd != '\r')
+            {
+                ++lineEnd;
+            }
+            ++chunk.numLines;
+            if (!parseLine(chunk, line, lineEnd))
+            {
+                chunk.errorLine = chunk.numLines;
+                return;
+            }
+            line = skipLine(lineEnd, chunk.end);
+        }
+    }
+
+    /// Turn the chunk relative indices into absolute ones and check their range
+    void resolveChunk(Chunk& chunk, int numPositions, int numTexCoords)
+    {
+        for (Corner& corner : chunk.corners)
+        {
+            if (corner.flags & POSITION_RELATIVE)
+            {
+                corner.position += chunk.positionOffset;
+            }
+            if (corner.flags & TEXCOORD_RELATIVE)
+            {
+                corner.texCoord += chunk.texCoordOffset;
+            }
+            if (corner.position < 0 || corner.position >= numPositions ||
+                (!(corner.flags & TEXCOORD_MISSING) && (corner.texCoord < 0 || corner.texCoord >= numTexCoords)))
+            {
+                chunk.indexOutOfRange = true;
+                return;
+            }
+        }
+    }
+
+    /// Point in polygon test, as used by tinyobj
+    int pnpoly(int nvert, const float* vertx, const float* verty, float testx, float testy)
+    {
+        int i, j, c = 0;
+        for (i = 0, j = nvert - 1; i < nvert; j = i++)
+        {
+            if (((verty[i] > testy) != (verty[j] > testy)) &&
+                (testx < (vertx[j] - vertx[i]) * (testy - verty[i]) / (verty[j] - verty[i]) + vertx[i]))
+            {
+                c = !c;
+            }
+        }
+        return c;
+    }
+
+    /// Split a face into triangles with the ear clipping of tinyobj's exportGroupsToShape
+    /*
+    * All indices must be in range. remaining is scratch space reused between faces.
+    */
+    void triangulateFace(const Corner* face, size_t numCorners, const std::vector<float>& v,
+                         std::vector<Corner>& triangles, std::vector<Corner>& remaining)
+    {
+        if (numCorners < 3)
+        {
+            // Points and lines have no area
+            return;
+        }
+        if (numCorners == 3)
+        {
+            triangles.insert(triangles.end(), face, face + 3);
+            return;
+        }
+
+        // Project onto the plane of the two axes with the largest normal component
+        size_t axes[2] = { 1, 2 };
+        for (size_t k = 0; k < numCorners; ++k)
+        {
+            size_t vi0 = static_cast<size_t>(face[(k + 0) % numCorners].position);
+            size_t vi1 = static_cast<size_t>(face[(k + 1) % numCorners].position);
+            size_t vi2 = static_cast<size_t>(face[(k + 2) % numCorners].position);
+            float e0x = v[vi1 * 3 + 0] - v[vi0 * 3 + 0];
+            float e0y = v[vi1 * 3 + 1] - v[vi0 * 3 + 1];
+            float e0z = v[vi1 * 3 + 2] - v[vi0 * 3 + 2];
+            float e1x = v[vi2 * 3 + 0] - v[vi1 * 3 + 0];
+            float e1y = v[vi2 * 3 + 1] - v[vi1 * 3 + 1];
+            float e1z = v[vi2 * 3 + 2] - v[vi1 * 3 + 2];
+            float cx = std::fabs(e0y * e1z - e0z * e1y);
+            float cy = std::fabs(e0z * e1x - e0x * e1z);
+            float cz = std::fabs(e0x * e1y - e0y * e1x);
+            const float epsilon = std::numeric_limits<float>::epsilon();
+            if (cx > epsilon || cy > epsilon || cz > epsilon)
+            {
+                if (!(cx > cy && cx > cz))
+                {
+                    axes[0] = 0;
+                    if (cz > cx && cz > cy)
+                    {
+                        axes[1] = 1;
+                    }
+                }
+                break;
+            }
+        }
+
+        float area = 0;
+        for (size_t k = 0; k < numCorners; ++k)
+        {
+            size_t vi0 = static_cast<size_t>(face[(k + 0) % numCorners].position);
+            size_t vi1 = static_cast<size_t>(face[(k + 1) % numCorners].position);
+            float v0x = v[vi0 * 3 + axes[0]];
+            float v0y = v[vi0 * 3 + axes[1]];
+            float v1x = v[vi1 * 3 + axes[0]];
+            float v1y = v[vi1 * 3 + axes[1]];
+            area += (v0x * v1y - v0y * v1x) * 0.5f;
+        }
+
+        remaining.assign(face, face + numCorners);
+        size_t guessVert = 0;
+        Corner ind[3];
+        float vx[3];
+        float vy[3];
+
+        // Give up if a full round over the remaining corners finds no ear
+        size_t remainingIterations = numCorners;
+        size_t previousRemainingCorners = numCorners;
+
+        while (remaining.size() > 3 && remainingIterations > 0)
+        {
+            size_t npolys = remaining.size();
+            if (guessVert >= npolys)
+            {
+                guessVert -= npolys;
+            }
+
+            if (previousRemainingCorners != npolys)
+            {
+                previousRemainingCorners = npolys;
+                remainingIterations = npolys;
+            }
+            else
+            {
+                --remainingIterations;
+            }
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                ind[k] = remaining[(guessVert + k) % npolys];
+                size_t vi = static_cast<size_t>(ind[k].position);
+                vx[k] = v[vi * 3 + axes[0]];
+                vy[k] = v[vi * 3 + axes[1]];
+            }
+            float e0x = vx[1] - vx[0];
+            float e0y = vy[1] - vy[0];
+            float e1x = vx[2] - vx[1];
+            float e1y = vy[2] - vy[1];
+            float cross = e0x * e1y - e0y * e1x;
+            // Reflex corner, not an ear
+            if (cross * area < 0.0f)
+            {
+                guessVert += 1;
+                continue;
+            }
+
+            // An ear must not contain any of the other corners
+            bool overlap = false;
+            for (size_t otherVert = 3; otherVert < npolys; ++otherVert)
+            {
+                size_t ovi = static_cast<size_t>(remaining[(guessVert + otherVert) % npolys].position);
+                float tx = v[ovi * 3 + axes[0]];
+                float ty = v[ovi * 3 + axes[1]];
+                if (pnpoly(3, vx, vy, tx, ty))
+                {
+                    overlap = true;
+                    break;
+                }
+            }
+            if (overlap)
+            {
+                guessVert += 1;
+                continue;
+            }
+
+            triangles.insert(triangles.end(), ind, ind + 3);
+
+            // Clip the ear's middle corner
+            remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>((guessVert + 1) % npolys));
+        }
+
+        if (remaining.size() == 3)
+        {
+            triangles.insert(triangles.end(), remaining.begin(), remaining.end());
+        }
+    }
+
+    void triangulateChunk(Chunk& chunk, const std::vector<float>& positions)
+    {
+        std::vector<Corner> remaining;
+        chunk.triangles.reserve(chunk.corners.size());
+        const Corner* face = chunk.corners.data();
+        for (int faceSize : chunk.faceSizes)
+        {
+            triangulateFace(face, static_cast<size_t>(faceSize), positions, chunk.triangles, remaining);
+            face += faceSize;
+        }
+        // The corners are not needed anymore
+        std::vector<Corner>().swap(chunk.corners);
+    }
+
+    /// Run function on every chunk, each on its own thread
+    void forEachChunk(std::vector<Chunk>& chunks, const std::function<void(Chunk&)>& function)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(chunks.size() - 1);
+        for (size_t i = 1; i < chunks.size(); ++i)
+        {
+            threads.emplace_back(function, std::ref(chunks[i]));
+        }
+        // The calling thread takes the first chunk
+        function(chunks[0]);
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+
+bool
+ObjParser::parse(const char* data, size_t size, ObjMesh& mesh, std::string& error,
+                 unsigned int maxThreads)
+{
+    mesh.vertices.clear();
+    mesh.texCoords.clear();
+    mesh.indices.clear();
+
+    if (maxThreads == 0)
+    {
+        maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    size_t numChunks = std::max<size_t>(std::min<size_t>(maxThreads, size / MIN_CHUNK_SIZE), 1);
+
+    // Split the data into chunks of about the same size, each ending after a line terminator
+    std::vector<Chunk> chunks;
+    chunks.reserve(numChunks);
+    const char* dataEnd = data + size;
+    const char* chunkBegin = data;
+    for (size_t i = 1; i <= numChunks && chunkBegin != dataEnd; ++i)
+    {
+        const char* chunkEnd = dataEnd;
+        if (i < numChunks)
+        {
+            chunkEnd = skipLine(std::max(chunkBegin, data + size / numChunks * i), dataEnd);
+        }
+        chunks.emplace_back();
+        chunks.back().begin = chunkBegin;
+        chunks.back().end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+    if (chunks.empty())
+    {
+        return true;
+    }
+
+    forEachChunk(chunks, parseChunk);
+
+    // Report the first invalid face in file order, like a sequential parse would
+    int lineOffset = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (chunk.errorLine != 0)
+        {
+            error = "Failed to parse face on line " + std::to_string(lineOffset + chunk.errorLine) +
+                " (e.g. zero value for face index)";
+            return false;
+        }
+        lineOffset += chunk.numLines;
+    }
+
+    // Merge the attributes, chunk indices are relative to the first attribute of the chunk
+    int numPositions = 0;
+    int numTexCoords = 0;
+    for (Chunk& chunk : chunks)
+    {
+        chunk.positionOffset = numPositions;
+        chunk.texCoordOffset = numTexCoords;
+        numPositions += static_cast<int>(chunk.positions.size() / 3);
+        numTexCoords += static_cast<int>(chunk.texCoords.size() / 2);
+    }
+    std::vector<float> positions;
+    std::vector<float> texCoords;
+    positions.reserve(static_cast<size_t>(numPositions) * 3);
+    texCoords.reserve(static_cast<size_t>(numTexCoords) * 2);
+    for (Chunk& chunk : chunks)
+    {
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+        std::vector<float>().swap(chunk.positions);
+        std::vector<float>().swap(chunk.texCoords);
+    }
+
+    forEachChunk(chunks, [&](Chunk& chunk)
+    {
+        resolveChunk(chunk, numPositions, numTexCoords);
+        if (!chunk.indexOutOfRange)
+        {
+            triangulateChunk(chunk, positions);
+        }
+    });
+
+    size_t numTriangleCorners = 0;
+    for (const Chunk& chunk : chunks)
+    {
+        if (chunk.indexOutOfRange)
+        {
+            error = "Face index out of range";
+            return false;
+        }
+        numTriangleCorners += chunk.triangles.size();
+    }
+
+    // Emit one vertex per distinct (position, texture coordinate) pair. The
+    // vertices sharing a position are chained, starting from firstVertex.
+    std::vector<uint32_t> firstVertex(static_cast<size_t>(numPositions), INVALID_INDEX);
+    std::vector<uint32_t> nextVertex;
+    std::vector<int> vertexTexCoord;
+    mesh.indices.reserve(numTriangleCorners);
+    for (const Chunk& chunk : chunks)
+    {
+        for (const Corner& corner : chunk.triangles)
+        {
+            size_t position = static_cast<size_t>(corner.position);
+            uint32_t vertex = firstVertex[position];
+            while (vertex != INVALID_INDEX && vertexTexCoord[vertex] != corner.texCoord)
+            {
+                vertex = nextVertex[vertex];
+            }
+
+            if (vertex == INVALID_INDEX)
+            {
+                vertex = static_cast<uint32_t>(vertexTexCoord.size());
+                nextVertex.push_back(firstVertex[position]);
+                firstVertex[position] = vertex;
+                vertexTexCoord.push_back(corner.texCoord);
+
+                mesh.vertices.insert(mesh.vertices.end(), &positions[position * 3], &positions[position * 3] + 3);
+                if (corner.texCoord < 0)
+                {
+                    // Missing texture coordinates are set to 0,0 like the sample always did
+                    mesh.texCoords.push_back(0.f);
+                    mesh.texCoords.push_back(0.f);
+                }
+                else
+                {
+                    size_t texCoord = static_cast<size_t>(corner.texCoord);
+                    mesh.texCoords.insert(mesh.texCoords.end(), &texCoords[texCoord * 2], &texCoords[texCoord * 2] + 2);
+                }
+            }
+            mesh.indices.push_back(vertex);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __OBJ_PARSER_H__
+#define __OBJ_PARSER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/// Indexed triangle mesh produced by ObjParser
+struct ObjMesh
+{
+    /// 3 floats per vertex
+    std::vector<float> vertices;
+    /// 2 floats per vertex, (0,0) for face vertices without a texture coordinate
+    std::vector<float> texCoords;
+    /// 3 indices per triangle
+    std::vector<uint32_t> indices;
+};
+
+
+/// Multi-threaded parser for the geometry of Wavefront OBJ files
+/**
+ * The parser works directly on the file contents in memory, typically a mapped
+ * file or asset. The data is split into chunks at line boundaries which are
+ * parsed in parallel without copying or allocating per line, then the chunks
+ * are merged and every distinct pair of position and texture coordinate index
+ * becomes one vertex of the indexed output.
+ *
+ * Only positions, texture coordinates and faces are read, all other statements
+ * are ignored. The results match tinyobj::LoadObj with triangulation enabled:
+ * numbers are parsed with the same arithmetic, polygons are triangulated with
+ * the same ear clipping and triangles keep their order in the file, so
+ * expanding the indexed output reproduces tinyobj's face vertices exactly.
+ * Tests/ObjParserTest.cpp checks this with tiny_obj_loader.cpp as the reference.
+ */
+class ObjParser
+{
+public:
+    /// Parse size bytes of OBJ data into mesh
+    /*
+    * maxThreads limits the number of threads used, 0 uses one per hardware thread.
+    * Returns false and sets error if the data has invalid or out of range face indices.
+    */
+    static bool parse(const char* data, size_t size, ObjMesh& mesh, std::string& error,
+                      unsigned int maxThreads = 0);
+};
+
+#endif // __OBJ_PARSER_H__
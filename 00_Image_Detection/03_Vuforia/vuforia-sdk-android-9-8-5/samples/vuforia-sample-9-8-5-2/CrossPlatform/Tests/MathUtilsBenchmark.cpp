@@ -0,0 +1,105 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Microbenchmarks of the MathUtils matrix kernels. The build makes two
+// executables, one with the SIMD kernels of the host and one built with
+// MATH_UTILS_NO_SIMD as the scalar baseline.
+// Usage: MathUtilsBenchmark [iterations]
+
+#include "MathUtils.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    /// Run function iterations times and print the time per call, the checksum keeps the work alive
+    template <typename Function>
+    void run(const char* name, long iterations, int itemsPerCall, Function function)
+    {
+        float checksum = 0.f;
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < iterations; ++i)
+        {
+            checksum += function();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        double perItem = elapsed.count() / (static_cast<double>(iterations) * itemsPerCall);
+        std::printf("%-20s %8.2f ns per item (checksum %g)\n", name, perItem, checksum);
+    }
+
+    Vuforia::Matrix44F makeMatrix(float seed)
+    {
+        Vuforia::Matrix44F m;
+        for (int i = 0; i < 16; ++i)
+        {
+            m.data[i] = seed + 0.01f * static_cast<float>(i);
+        }
+        return m;
+    }
+}
+
+
+int
+main(int argc, char** argv)
+{
+    long iterations = argc > 1 ? std::atol(argv[1]) : 1000000;
+    if (iterations <= 0)
+    {
+        std::printf("Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+#if defined(MATH_UTILS_NO_SIMD)
+    std::printf("Scalar kernels, %ld iterations\n", iterations);
+#else
+    std::printf("Default kernels, %ld iterations\n", iterations);
+#endif
+
+    // Each call feeds a scaled down result into the next input, so calls can't be
+    // hoisted out of the loop and the values stay bounded
+    Vuforia::Matrix44F a = makeMatrix(0.1f);
+    Vuforia::Matrix44F b = makeMatrix(0.2f);
+    Vuforia::Matrix44F c;
+    run("multiplyMatrix", iterations, 1, [&]()
+    {
+        MathUtils::multiplyMatrix(a, b, c);
+        b.data[0] = 0.2f + c.data[0] * 1e-3f;
+        return c.data[5];
+    });
+
+    const int batchSize = 64;
+    std::vector<Vuforia::Matrix44F> batch(batchSize, makeMatrix(0.3f));
+    std::vector<Vuforia::Matrix44F> batchResult(batchSize);
+    run("multiplyMatrices", iterations / batchSize + 1, batchSize, [&]()
+    {
+        MathUtils::multiplyMatrices(a, batch.data(), batchResult.data(), batchSize);
+        batch[0].data[0] = 0.3f + batchResult[batchSize - 1].data[0] * 1e-3f;
+        return batchResult[0].data[0];
+    });
+
+    Vuforia::Vec4F v(1.f, 2.f, 3.f, 1.f);
+    run("Vec4FTransform", iterations, 1, [&]()
+    {
+        Vuforia::Vec4F r = MathUtils::Vec4FTransform(a, v);
+        v.data[0] = 1.f + r.data[0] * 1e-3f;
+        return r.data[1];
+    });
+
+    std::vector<Vuforia::Vec3F> points(batchSize, Vuforia::Vec3F(1.f, 2.f, 3.f));
+    std::vector<Vuforia::Vec3F> pointsResult(batchSize);
+    run("transformPoints", iterations / batchSize + 1, batchSize, [&]()
+    {
+        MathUtils::transformPoints(a, points.data(), pointsResult.data(), batchSize);
+        points[0].data[0] = 1.f + pointsResult[batchSize - 1].data[0] * 1e-3f;
+        return pointsResult[0].data[0];
+    });
+
+    return 0;
+}
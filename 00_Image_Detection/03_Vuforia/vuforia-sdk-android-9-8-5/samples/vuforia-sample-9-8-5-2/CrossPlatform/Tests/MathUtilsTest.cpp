@@ -0,0 +1,206 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Conformance of the MathUtils matrix kernels with a double precision reference.
+// The kernels may be SIMD or scalar and may or may not use fused multiply-add
+// depending on the build, so results are compared with a tolerance derived from
+// the rounding error bound of a 4 term dot product.
+
+#include "MathUtils.h"
+#include "TestUtils.h"
+
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::mt19937 generator(20200101);
+
+    float randomValue()
+    {
+        std::uniform_real_distribution<float> distribution(-10.f, 10.f);
+        return distribution(generator);
+    }
+
+    Vuforia::Matrix44F randomMatrix()
+    {
+        Vuforia::Matrix44F m;
+        for (float& value : m.data)
+        {
+            value = randomValue();
+        }
+        return m;
+    }
+
+    /// True if result is within the rounding error of a 4 term dot product of exact
+    /**
+     * magnitude is the sum of the absolute values of the terms. Each float
+     * product and sum adds at most one rounding error, fused or not.
+     */
+    bool isClose(float result, double exact, double magnitude)
+    {
+        return std::fabs(result - exact) <= 8.0 * FLT_EPSILON * magnitude + FLT_MIN;
+    }
+
+    /// Check c = a * b for column-major matrices
+    void checkProduct(const Vuforia::Matrix44F& a, const Vuforia::Matrix44F& b, const Vuforia::Matrix44F& c)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                double exact = 0.0;
+                double magnitude = 0.0;
+                for (int k = 0; k < 4; ++k)
+                {
+                    double term = static_cast<double>(a.data[k * 4 + row]) * b.data[col * 4 + k];
+                    exact += term;
+                    magnitude += std::fabs(term);
+                }
+                CHECK(isClose(c.data[col * 4 + row], exact, magnitude));
+            }
+        }
+    }
+
+    /// Check r = m * v for a column-major matrix
+    void checkTransform(const Vuforia::Matrix44F& m, const float* v, const float* r, int size)
+    {
+        for (int row = 0; row < size; ++row)
+        {
+            double exact = 0.0;
+            double magnitude = 0.0;
+            for (int k = 0; k < 4; ++k)
+            {
+                double term = static_cast<double>(m.data[k * 4 + row]) * v[k];
+                exact += term;
+                magnitude += std::fabs(term);
+            }
+            CHECK(isClose(r[row], exact, magnitude));
+        }
+    }
+
+    void testMultiplyMatrix()
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            Vuforia::Matrix44F a = randomMatrix();
+            Vuforia::Matrix44F b = randomMatrix();
+            Vuforia::Matrix44F c;
+            MathUtils::multiplyMatrix(a, b, c);
+            checkProduct(a, b, c);
+
+            // The result may alias either input
+            Vuforia::Matrix44F aliased = a;
+            MathUtils::multiplyMatrix(aliased, b, aliased);
+            checkProduct(a, b, aliased);
+            aliased = b;
+            MathUtils::multiplyMatrix(a, aliased, aliased);
+            checkProduct(a, b, aliased);
+        }
+
+        // Products with the identity only add zeros and are exact
+        Vuforia::Matrix44F identity = MathUtils::Matrix44FIdentity();
+        Vuforia::Matrix44F m = randomMatrix();
+        Vuforia::Matrix44F c;
+        MathUtils::multiplyMatrix(identity, m, c);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK(c.data[i] == m.data[i]);
+        }
+        MathUtils::multiplyMatrix(m, identity, c);
+        for (int i = 0; i < 16; ++i)
+        {
+            CHECK(c.data[i] == m.data[i]);
+        }
+    }
+
+    void testMultiplyMatrices()
+    {
+        const int count = 37;
+        Vuforia::Matrix44F a = randomMatrix();
+        std::vector<Vuforia::Matrix44F> b(count);
+        for (Vuforia::Matrix44F& m : b)
+        {
+            m = randomMatrix();
+        }
+
+        std::vector<Vuforia::Matrix44F> c(count);
+        MathUtils::multiplyMatrices(a, b.data(), c.data(), count);
+        for (int n = 0; n < count; ++n)
+        {
+            checkProduct(a, b[n], c[n]);
+        }
+
+        std::vector<Vuforia::Matrix44F> inPlace = b;
+        MathUtils::multiplyMatrices(a, inPlace.data(), inPlace.data(), count);
+        for (int n = 0; n < count; ++n)
+        {
+            checkProduct(a, b[n], inPlace[n]);
+        }
+
+        // A may be one of the results, every product uses its value from before the call
+        std::vector<Vuforia::Matrix44F> aliased = b;
+        aliased[0] = a;
+        MathUtils::multiplyMatrices(aliased[0], aliased.data(), aliased.data(), count);
+        checkProduct(a, a, aliased[0]);
+        for (int n = 1; n < count; ++n)
+        {
+            checkProduct(a, b[n], aliased[n]);
+        }
+
+        // An empty batch doesn't touch the arrays
+        MathUtils::multiplyMatrices(a, nullptr, nullptr, 0);
+    }
+
+    void testTransform()
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            Vuforia::Matrix44F m = randomMatrix();
+            Vuforia::Vec4F v;
+            for (float& value : v.data)
+            {
+                value = randomValue();
+            }
+            Vuforia::Vec4F r = MathUtils::Vec4FTransform(m, v);
+            checkTransform(m, v.data, r.data, 4);
+        }
+
+        const int count = 53;
+        Vuforia::Matrix44F m = randomMatrix();
+        std::vector<Vuforia::Vec3F> points(count);
+        for (Vuforia::Vec3F& point : points)
+        {
+            for (float& value : point.data)
+            {
+                value = randomValue();
+            }
+        }
+        std::vector<Vuforia::Vec3F> result(count);
+        MathUtils::transformPoints(m, points.data(), result.data(), count);
+        std::vector<Vuforia::Vec3F> inPlace = points;
+        MathUtils::transformPoints(m, inPlace.data(), inPlace.data(), count);
+        for (int n = 0; n < count; ++n)
+        {
+            float v[4] = { points[n].data[0], points[n].data[1], points[n].data[2], 1.f };
+            checkTransform(m, v, result[n].data, 3);
+            checkTransform(m, v, inPlace[n].data, 3);
+        }
+    }
+}
+
+
+int
+main()
+{
+    testMultiplyMatrix();
+    testMultiplyMatrices();
+    testTransform();
+    return testResult("MathUtilsTest");
+}
@@ -0,0 +1,167 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// MeshOptimizer must only reorder triangles and vertices: the optimized mesh
+// has to contain exactly the triangles of the input, with the same winding,
+// and must not make worse use of the vertex cache than the input.
+// Checked on built-in cases and the OBJ files passed on the command line.
+// Usage: MeshOptimizerTest [file.obj...]
+
+#include "MeshOptimizer.h"
+#include "ObjParser.h"
+#include "TestUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// Position and texture coordinate of a vertex
+    typedef std::array<float, 5> Vertex;
+    typedef std::array<Vertex, 3> Triangle;
+
+    /// Triangles of mesh by value, rotated to start at their smallest vertex and sorted
+    std::vector<Triangle> getTriangles(const ObjMesh& mesh)
+    {
+        std::vector<Triangle> triangles(mesh.indices.size() / 3);
+        for (size_t i = 0; i < triangles.size(); ++i)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                uint32_t index = mesh.indices[i * 3 + k];
+                Vertex& vertex = triangles[i][k];
+                std::memcpy(&vertex[0], &mesh.vertices[index * 3], 3 * sizeof(float));
+                std::memcpy(&vertex[3], &mesh.texCoords[index * 2], 2 * sizeof(float));
+            }
+            // Rotating keeps the winding
+            std::rotate(triangles[i].begin(), std::min_element(triangles[i].begin(), triangles[i].end()),
+                        triangles[i].end());
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    /// Optimize mesh and check that it keeps its triangles
+    void checkOptimize(const std::string& name, ObjMesh mesh)
+    {
+        std::vector<Triangle> expected = getTriangles(mesh);
+        size_t numVertices = mesh.vertices.size() / 3;
+        std::vector<uint32_t> indices = mesh.indices;
+        MeshOptimizer::CacheStatistics before =
+            MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), numVertices);
+
+        bool optimized = MeshOptimizer::optimize(mesh);
+        CHECK(optimized || expected.empty() || mesh.indices == indices);
+        CHECK(optimized || mesh.vertices.size() / 3 == numVertices);
+
+        // Only the number of vertices used counts, which doesn't change
+        MeshOptimizer::CacheStatistics after =
+            MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), numVertices);
+        CHECK(after.acmr <= before.acmr);
+
+        bool indicesValid = mesh.vertices.size() / 3 == mesh.texCoords.size() / 2 &&
+                            mesh.vertices.size() / 3 <= numVertices;
+        for (uint32_t index : mesh.indices)
+        {
+            indicesValid = indicesValid && index < mesh.vertices.size() / 3;
+        }
+        CHECK(indicesValid);
+        bool trianglesKept = indicesValid && getTriangles(mesh) == expected;
+        if (!trianglesKept)
+        {
+            std::printf("%s: the optimized mesh doesn't have the same triangles\n", name.c_str());
+        }
+        CHECK(trianglesKept);
+    }
+
+    void checkOptimize(const std::string& name, const std::string& data)
+    {
+        ObjMesh mesh;
+        std::string error;
+        bool parsed = ObjParser::parse(data.data(), data.size(), mesh, error);
+        CHECK(parsed);
+        if (parsed)
+        {
+            checkOptimize(name, mesh);
+        }
+    }
+
+    /// Grid of size x size quads as two triangles each
+    std::string makeGrid(int size)
+    {
+        std::ostringstream stream;
+        for (int y = 0; y <= size; ++y)
+        {
+            for (int x = 0; x <= size; ++x)
+            {
+                stream << "v " << x << ' ' << y << " 0\nvt " << x << ' ' << y << '\n';
+            }
+        }
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                int a = y * (size + 1) + x + 1;
+                int b = a + 1;
+                int c = b + size + 1;
+                int d = a + size + 1;
+                stream << "f " << a << '/' << a << ' ' << b << '/' << b << ' ' << c << '/' << c << '\n'
+                       << "f " << a << '/' << a << ' ' << c << '/' << c << ' ' << d << '/' << d << '\n';
+            }
+        }
+        return stream.str();
+    }
+
+    std::string readFile(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+}
+
+
+int
+main(int argc, char** argv)
+{
+    checkOptimize("empty", ObjMesh());
+    checkOptimize("triangle", std::string("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n"));
+
+    // A degenerate first triangle hits the cache on its repeated vertex
+    checkOptimize("degenerate first triangle",
+                  std::string("v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nv 2 2 0\n"
+                              "f 1 1 2\nf 1 2 3\nf 2 4 3\nf 3 4 5\nf 5 5 5\n"));
+
+    // Unused vertices are dropped, duplicate triangles are kept
+    ObjMesh unused;
+    unused.vertices = { 9.f, 9.f, 9.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f, 8.f, 8.f, 8.f };
+    unused.texCoords = { 0.9f, 0.9f, 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 0.8f, 0.8f };
+    unused.indices = { 1, 2, 3, 1, 2, 3, 3, 2, 1 };
+    checkOptimize("unused vertices", unused);
+
+    // A grid in row order makes poor use of the cache and must be optimized
+    ObjMesh grid;
+    std::string error;
+    std::string gridData = makeGrid(100);
+    CHECK(ObjParser::parse(gridData.data(), gridData.size(), grid, error));
+    checkOptimize("grid", grid);
+    CHECK(MeshOptimizer::optimize(grid));
+
+    for (int i = 1; i < argc; ++i)
+    {
+        checkOptimize(argv[i], readFile(argv[i]));
+    }
+    std::printf("Optimized %d files\n", argc - 1);
+
+    return testResult("MeshOptimizerTest");
+}
@@ -0,0 +1,199 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Error bounds of MeshQuantizer. Attributes are decoded the way GL and the
+// model vertex shader do, and every component must be within half a
+// quantization step of the original: the range of the axis / 65534 for
+// positions (snorm16 over [-1, 1]) and / 65535 for texture coordinates.
+
+#include "MeshQuantizer.h"
+#include "TestUtils.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    /// Normalized value GL passes to the shader for an int16 attribute
+    float decodeSnorm16(int16_t value)
+    {
+        return std::max(static_cast<float>(value) / 32767.f, -1.f);
+    }
+
+    /// Normalized value GL passes to the shader for a uint16 attribute
+    float decodeUnorm16(uint16_t value)
+    {
+        return static_cast<float>(value) / 65535.f;
+    }
+
+    /// Allowed error for a component in [minimum, maximum] stored with numSteps steps
+    /**
+     * Half a step, plus float rounding of the encoding and decoding arithmetic.
+     */
+    float getTolerance(float minimum, float maximum, float numSteps)
+    {
+        float magnitude = std::max(std::fabs(minimum), std::fabs(maximum));
+        return 0.5f * (maximum - minimum) / numSteps + 8.f * FLT_EPSILON * magnitude;
+    }
+
+    /// Check every decoded component of quantized against mesh
+    void checkBounds(const ObjMesh& mesh, const QuantizedMesh& quantized)
+    {
+        CHECK(quantized.vertices.size() == mesh.vertices.size());
+        CHECK(quantized.texCoords.size() == mesh.texCoords.size());
+        if (quantized.vertices.size() != mesh.vertices.size() || quantized.texCoords.size() != mesh.texCoords.size())
+        {
+            return;
+        }
+
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            float minimum = FLT_MAX;
+            float maximum = -FLT_MAX;
+            for (size_t i = axis; i < mesh.vertices.size(); i += 3)
+            {
+                minimum = std::min(minimum, mesh.vertices[i]);
+                maximum = std::max(maximum, mesh.vertices[i]);
+            }
+            float tolerance = getTolerance(minimum, maximum, 65534.f);
+            for (size_t i = axis; i < mesh.vertices.size(); i += 3)
+            {
+                float decoded = decodeSnorm16(quantized.vertices[i]) * quantized.positionScale[axis] +
+                    quantized.positionOffset[axis];
+                CHECK(std::fabs(decoded - mesh.vertices[i]) <= tolerance);
+            }
+        }
+
+        for (size_t axis = 0; axis < 2; ++axis)
+        {
+            float minimum = FLT_MAX;
+            float maximum = -FLT_MAX;
+            for (size_t i = axis; i < mesh.texCoords.size(); i += 2)
+            {
+                minimum = std::min(minimum, mesh.texCoords[i]);
+                maximum = std::max(maximum, mesh.texCoords[i]);
+            }
+            float tolerance = getTolerance(minimum, maximum, 65535.f);
+            for (size_t i = axis; i < mesh.texCoords.size(); i += 2)
+            {
+                float decoded = decodeUnorm16(quantized.texCoords[i]) * quantized.texCoordScale[axis] +
+                    quantized.texCoordOffset[axis];
+                CHECK(std::fabs(decoded - mesh.texCoords[i]) <= tolerance);
+            }
+        }
+    }
+
+    ObjMesh makeRandomMesh(size_t numVertices, float positionMinimum, float positionMaximum,
+                           float texCoordMinimum, float texCoordMaximum)
+    {
+        std::mt19937 generator(20200101);
+        std::uniform_real_distribution<float> position(positionMinimum, positionMaximum);
+        std::uniform_real_distribution<float> texCoord(texCoordMinimum, texCoordMaximum);
+        ObjMesh mesh;
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            mesh.vertices.push_back(position(generator));
+            mesh.vertices.push_back(position(generator) * 0.01f);
+            mesh.vertices.push_back(position(generator) + 1000.f);
+            mesh.texCoords.push_back(texCoord(generator));
+            mesh.texCoords.push_back(texCoord(generator));
+        }
+        return mesh;
+    }
+
+    void testRandomMesh()
+    {
+        ObjMesh mesh = makeRandomMesh(10000, -3.f, 5.f, 0.f, 1.f);
+        QuantizedMesh quantized;
+        MeshQuantizer::quantize(mesh, quantized);
+        checkBounds(mesh, quantized);
+
+        // measureError agrees with the per axis bounds, z has the widest range and largest magnitude
+        MeshQuantizer::ErrorStatistics error = MeshQuantizer::measureError(mesh, quantized);
+        CHECK(error.maxPositionError > 0.f);
+        CHECK(error.rmsPositionError <= error.maxPositionError);
+        CHECK(error.maxPositionError <= std::sqrt(3.f) * getTolerance(995.f, 1005.f, 65534.f));
+        CHECK(error.relativePositionError < 1e-4f);
+        CHECK(error.maxTexCoordError <= getTolerance(0.f, 1.f, 65535.f));
+    }
+
+    void testFlatAxis()
+    {
+        // A planar mesh, z has no range and must decode to its only value
+        ObjMesh mesh = makeRandomMesh(100, -1.f, 1.f, 0.f, 1.f);
+        for (size_t i = 2; i < mesh.vertices.size(); i += 3)
+        {
+            mesh.vertices[i] = 0.375f;
+        }
+        // Constant v coordinate too
+        for (size_t i = 1; i < mesh.texCoords.size(); i += 2)
+        {
+            mesh.texCoords[i] = 0.5f;
+        }
+
+        QuantizedMesh quantized;
+        MeshQuantizer::quantize(mesh, quantized);
+        checkBounds(mesh, quantized);
+        CHECK(quantized.positionScale[2] == 0.f);
+        CHECK(quantized.positionOffset[2] == 0.375f);
+        for (size_t i = 2; i < quantized.vertices.size(); i += 3)
+        {
+            CHECK(decodeSnorm16(quantized.vertices[i]) * quantized.positionScale[2] +
+                  quantized.positionOffset[2] == 0.375f);
+        }
+        for (size_t i = 1; i < quantized.texCoords.size(); i += 2)
+        {
+            CHECK(decodeUnorm16(quantized.texCoords[i]) * quantized.texCoordScale[1] +
+                  quantized.texCoordOffset[1] == 0.5f);
+        }
+    }
+
+    void testRepeatingTexCoords()
+    {
+        // Texture coordinates outside [0, 1] for a texture repeated over the mesh
+        ObjMesh mesh = makeRandomMesh(1000, -1.f, 1.f, -2.5f, 7.f);
+        mesh.texCoords[0] = -2.5f;
+        mesh.texCoords[1] = 7.f;
+
+        QuantizedMesh quantized;
+        MeshQuantizer::quantize(mesh, quantized);
+        checkBounds(mesh, quantized);
+        CHECK(quantized.texCoordOffset[0] == -2.5f);
+        CHECK(quantized.texCoords[0] == 0);
+        CHECK(quantized.texCoords[1] == 65535);
+    }
+
+    void testEmptyMesh()
+    {
+        ObjMesh mesh;
+        QuantizedMesh quantized;
+        quantized.vertices.resize(3);
+        quantized.texCoords.resize(2);
+        MeshQuantizer::quantize(mesh, quantized);
+        CHECK(quantized.vertices.empty());
+        CHECK(quantized.texCoords.empty());
+
+        MeshQuantizer::ErrorStatistics error = MeshQuantizer::measureError(mesh, quantized);
+        CHECK(error.maxPositionError == 0.f);
+        CHECK(error.rmsPositionError == 0.f);
+        CHECK(error.relativePositionError == 0.f);
+        CHECK(error.maxTexCoordError == 0.f);
+    }
+}
+
+
+int
+main()
+{
+    testRandomMesh();
+    testFlatAxis();
+    testRepeatingTexCoords();
+    testEmptyMesh();
+    return testResult("MeshQuantizerTest");
+}
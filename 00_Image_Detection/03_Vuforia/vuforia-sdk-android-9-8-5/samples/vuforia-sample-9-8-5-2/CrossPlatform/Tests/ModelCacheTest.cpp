@@ -0,0 +1,192 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Round trips of float and quantized models through ModelCache, and rejection
+// of entries that are stale, corrupted or missing.
+
+#include "ModelCache.h"
+#include "TestUtils.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+namespace
+{
+    /// Byte offset of the version in the cache file header
+    const long VERSION_OFFSET = 4;
+
+    /// Size of the cache file header
+    const size_t HEADER_SIZE = 72;
+
+    /// Check that loaded has the geometry of stored, componentSize is the size of one attribute component
+    void checkEqual(const ModelCache::Model& stored, const ModelCache::Model& loaded, size_t componentSize)
+    {
+        size_t numVertices = static_cast<size_t>(stored.numVertices);
+        CHECK(loaded.numVertices == stored.numVertices);
+        CHECK(loaded.vertexFormat == stored.vertexFormat);
+        CHECK(loaded.numIndices == stored.numIndices);
+        CHECK(loaded.indexSize == stored.indexSize);
+        if (loaded.numVertices != stored.numVertices || loaded.numIndices != stored.numIndices ||
+            loaded.indexSize != stored.indexSize)
+        {
+            return;
+        }
+        CHECK(std::memcmp(loaded.vertices, stored.vertices, numVertices * 3 * componentSize) == 0);
+        CHECK(std::memcmp(loaded.texCoords, stored.texCoords, numVertices * 2 * componentSize) == 0);
+        CHECK(std::memcmp(loaded.indices, stored.indices,
+                          static_cast<size_t>(stored.numIndices * stored.indexSize)) == 0);
+        CHECK(reinterpret_cast<uintptr_t>(loaded.indices) % static_cast<uintptr_t>(loaded.indexSize) == 0);
+        CHECK(std::memcmp(loaded.positionScale, stored.positionScale, sizeof(stored.positionScale)) == 0);
+        CHECK(std::memcmp(loaded.positionOffset, stored.positionOffset, sizeof(stored.positionOffset)) == 0);
+        CHECK(std::memcmp(loaded.texCoordScale, stored.texCoordScale, sizeof(stored.texCoordScale)) == 0);
+        CHECK(std::memcmp(loaded.texCoordOffset, stored.texCoordOffset, sizeof(stored.texCoordOffset)) == 0);
+    }
+
+    /// Overwrite size bytes of the file at offset
+    bool patchFile(const std::string& path, long offset, const void* data, size_t size)
+    {
+        FILE* file = std::fopen(path.c_str(), "r+b");
+        if (file == nullptr)
+        {
+            return false;
+        }
+        bool written = std::fseek(file, offset, SEEK_SET) == 0 && std::fwrite(data, 1, size, file) == size;
+        return std::fclose(file) == 0 && written;
+    }
+
+    void testFloatModel(ModelCache& cache, const std::string& directory)
+    {
+        // 4 vertices, 2 triangles with 16-bit indices
+        const float vertices[] = { 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 1.f, 1.f, 0.f, 0.f, 1.f, 0.f };
+        const float texCoords[] = { 0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.f, 1.f };
+        const uint16_t indices[] = { 0, 1, 2, 0, 2, 3 };
+        ModelCache::Model model;
+        model.numVertices = 4;
+        model.vertices = vertices;
+        model.texCoords = texCoords;
+        model.numIndices = 6;
+        model.indexSize = sizeof(uint16_t);
+        model.indices = indices;
+
+        const uint64_t key = ModelCache::computeKey("float", 5, 0);
+        CHECK(cache.store("float", key, model));
+        ModelCache::Model loaded;
+        CHECK(cache.load("float", key, loaded));
+        checkEqual(model, loaded, sizeof(float));
+
+        // Stale entries
+        CHECK(!cache.load("float", key + 1, loaded));
+        CHECK(!cache.load("missing", key, loaded));
+
+        std::string path = directory + "/float.cache";
+        const uint32_t otherVersion = 0xFFFFFFFF;
+        CHECK(patchFile(path, VERSION_OFFSET, &otherVersion, sizeof(otherVersion)));
+        CHECK(!cache.load("float", key, loaded));
+
+        // A new store replaces the stale entry, then truncate it
+        CHECK(cache.store("float", key, model));
+        CHECK(cache.load("float", key, loaded));
+        off_t size = static_cast<off_t>(HEADER_SIZE + sizeof(vertices) + sizeof(texCoords) + sizeof(indices));
+        CHECK(truncate(path.c_str(), size - 1) == 0);
+        CHECK(!cache.load("float", key, loaded));
+        CHECK(truncate(path.c_str(), static_cast<off_t>(HEADER_SIZE - 1)) == 0);
+        CHECK(!cache.load("float", key, loaded));
+    }
+
+    void testQuantizedModel(ModelCache& cache, const std::string& directory)
+    {
+        // 3 vertices of 10 bytes each, so the 32-bit indices follow 2 bytes of padding
+        const int16_t vertices[] = { -32767, -32767, 0, 32767, -32767, 0, 0, 32767, 0 };
+        const uint16_t texCoords[] = { 0, 0, 65535, 0, 32768, 65535 };
+        const uint32_t indices[] = { 0, 1, 2, 2, 1, 0 };
+        ModelCache::Model model;
+        model.numVertices = 3;
+        model.vertexFormat = ModelCache::VertexFormat::QUANTIZED;
+        model.vertices = vertices;
+        model.texCoords = texCoords;
+        const float positionScale[3] = { 2.f, 3.f, 0.f };
+        const float positionOffset[3] = { -1.f, 0.5f, 7.f };
+        std::memcpy(model.positionScale, positionScale, sizeof(positionScale));
+        std::memcpy(model.positionOffset, positionOffset, sizeof(positionOffset));
+        model.texCoordScale[0] = 4.f;
+        model.texCoordOffset[1] = -1.f;
+        model.numIndices = 6;
+        model.indexSize = sizeof(uint32_t);
+        model.indices = indices;
+
+        const uint64_t key = ModelCache::computeKey("quantized", 9, 2);
+        CHECK(key != ModelCache::computeKey("quantized", 9, 0));
+        CHECK(cache.store("quantized", key, model));
+        ModelCache::Model loaded;
+        CHECK(cache.load("quantized", key, loaded));
+        checkEqual(model, loaded, sizeof(uint16_t));
+
+        // An index of a vertex the model doesn't have
+        std::string path = directory + "/quantized.cache";
+        long indicesOffset = static_cast<long>(HEADER_SIZE + sizeof(vertices) + sizeof(texCoords) + 2);
+        const uint32_t outOfRange = 3;
+        CHECK(patchFile(path, indicesOffset + 4, &outOfRange, sizeof(outOfRange)));
+        CHECK(!cache.load("quantized", key, loaded));
+
+        // Indices that don't form whole triangles
+        model.numIndices = 5;
+        CHECK(cache.store("quantized", key, model));
+        CHECK(!cache.load("quantized", key, loaded));
+    }
+
+    void testDisabledCache()
+    {
+        ModelCache cache("");
+        CHECK(!cache.isEnabled());
+
+        const float vertices[] = { 0.f, 0.f, 0.f };
+        const float texCoords[] = { 0.f, 0.f };
+        const uint32_t indices[] = { 0, 0, 0 };
+        ModelCache::Model model;
+        model.numVertices = 1;
+        model.vertices = vertices;
+        model.texCoords = texCoords;
+        model.numIndices = 3;
+        model.indices = indices;
+        CHECK(!cache.store("disabled", 1, model));
+        CHECK(!cache.load("disabled", 1, model));
+    }
+}
+
+
+int
+main()
+{
+    char directoryTemplate[] = "/tmp/ModelCacheTestXXXXXX";
+    const char* directory = mkdtemp(directoryTemplate);
+    if (directory == nullptr)
+    {
+        std::printf("Error creating a temporary directory\n");
+        return 1;
+    }
+
+    {
+        ModelCache cache(directory);
+        CHECK(cache.isEnabled());
+        testFloatModel(cache, directory);
+        testQuantizedModel(cache, directory);
+    }
+    testDisabledCache();
+
+    for (const char* name : { "float", "quantized" })
+    {
+        std::remove((std::string(directory) + "/" + name + ".cache").c_str());
+    }
+    rmdir(directory);
+
+    return testResult("ModelCacheTest");
+}
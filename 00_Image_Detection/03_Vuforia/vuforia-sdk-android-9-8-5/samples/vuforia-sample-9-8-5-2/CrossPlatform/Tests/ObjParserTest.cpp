@@ -0,0 +1,201 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+// Conformance of ObjParser with tinyobj::LoadObj, the loader it replaced.
+// Every face vertex of the indexed output must match tinyobj's bit for bit,
+// for the built-in cases, a generated mesh large enough to be split into
+// several chunks, and the OBJ files passed on the command line.
+// Usage: ObjParserTest [file.obj...]
+
+#include "MemoryStream.h"
+#include "ObjParser.h"
+#include "TestUtils.h"
+#include "tiny_obj_loader.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /// Face vertices without indexing, 3 position and 2 texture coordinate floats each
+    struct FaceVertices
+    {
+        std::vector<float> positions;
+        std::vector<float> texCoords;
+    };
+
+    /// Load data with tinyobj, return false if it reports an error
+    bool loadReference(const std::string& data, FaceVertices& result)
+    {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning;
+        std::string error;
+        MemoryInputStream stream(data.data(), data.size());
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, &stream) || !error.empty())
+        {
+            return false;
+        }
+
+        for (const tinyobj::shape_t& shape : shapes)
+        {
+            for (const tinyobj::index_t& index : shape.mesh.indices)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    result.positions.push_back(attrib.vertices[3 * index.vertex_index + i]);
+                }
+                for (int i = 0; i < 2; ++i)
+                {
+                    result.texCoords.push_back(index.texcoord_index < 0 ? 0.f : attrib.texcoords[2 * index.texcoord_index + i]);
+                }
+            }
+        }
+        return true;
+    }
+
+    /// True if expanding the indices of mesh gives exactly the face vertices of reference
+    bool matchesReference(const ObjMesh& mesh, const FaceVertices& reference)
+    {
+        if (mesh.indices.size() * 3 != reference.positions.size() ||
+            mesh.vertices.size() / 3 != mesh.texCoords.size() / 2)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < mesh.indices.size(); ++i)
+        {
+            uint32_t index = mesh.indices[i];
+            if (index >= mesh.vertices.size() / 3 ||
+                std::memcmp(&mesh.vertices[index * 3], &reference.positions[i * 3], 3 * sizeof(float)) != 0 ||
+                std::memcmp(&mesh.texCoords[index * 2], &reference.texCoords[i * 2], 2 * sizeof(float)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Parse data with several thread counts and compare the results with tinyobj
+    void checkConformance(const std::string& name, const std::string& data)
+    {
+        FaceVertices reference;
+        bool referenceLoaded = loadReference(data, reference);
+
+        for (unsigned int maxThreads : { 1u, 3u, 0u })
+        {
+            ObjMesh mesh;
+            std::string error;
+            bool parsed = ObjParser::parse(data.data(), data.size(), mesh, error, maxThreads);
+            bool matches = parsed == referenceLoaded && (!parsed || matchesReference(mesh, reference));
+            if (!matches)
+            {
+                std::printf("%s: differs from tinyobj with %u threads (%s)\n", name.c_str(), maxThreads, error.c_str());
+            }
+            CHECK(matches);
+        }
+    }
+
+    /// Grid of quads with relative indices, texture coordinates and comments, large enough for several chunks
+    std::string makeGrid(int size)
+    {
+        std::ostringstream stream;
+        stream << "# generated grid\r\n";
+        for (int y = 0; y <= size; ++y)
+        {
+            for (int x = 0; x <= size; ++x)
+            {
+                stream << "v " << x * 0.125 << ' ' << y * -0.3 << ' ' << (x * y) % 7 << "e-3\r\n";
+                stream << "vt " << static_cast<double>(x) / size << ' ' << static_cast<double>(y) / size << '\n';
+            }
+            if (y == 0)
+            {
+                continue;
+            }
+            // The previous two rows are the last 2 * (size + 1) vertices
+            int row = size + 1;
+            for (int x = 0; x < size; ++x)
+            {
+                int a = -2 * row + x;
+                int b = a + 1;
+                int c = b + row;
+                int d = a + row;
+                stream << "f " << a << '/' << a << ' ' << b << '/' << b << ' ' << c << '/' << c << ' '
+                       << d << '/' << d << '\n';
+            }
+        }
+        return stream.str();
+    }
+
+    std::string readFile(const char* path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+}
+
+
+int
+main(int argc, char** argv)
+{
+    struct Case
+    {
+        const char* name;
+        const char* data;
+    };
+    const Case cases[] = {
+        { "empty", "" },
+        { "triangle", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n" },
+        { "no trailing newline", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3" },
+        { "crlf", "v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nf 1 2 3\r\n" },
+        { "numbers", "v -1.5E+1 +2. .5\nv 1e-40 -0 3.4028235e38\nv 0.1 0.2 0.30000001\nvt 0.123456789123 -7e-3\n"
+                     "f 1/1 2/1 3/1\n" },
+        { "relative indices", "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nvt 1 1\nf -3/-2 -2/-1 -1/-2\n" },
+        { "mixed texture coordinates", "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0.5 0.5\n"
+                                       "f 1 2 3\nf 1/1 3/1 4/1\nf 1//1 2//1 4//1\n" },
+        { "quad and pentagon", "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0.5 0.5 1e-2\n"
+                               "f 1 2 3 4\nf 1 2 3 5 4\n" },
+        { "concave polygon", "v 0 0 0\nv 2 0 0\nv 2 2 0\nv 1 0.5 0\nv 0 2 0\nf 1 2 3 4 5\n" },
+        { "vertical polygon", "v 0 0 0\nv 0 1 0\nv 0 1 1\nv 0 0.5 0.2\nv 0 0 1\nf 1 2 3 4 5\n" },
+        { "degenerate faces", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 1 2\nf 1 2\nf 1 2 3\n" },
+        { "ignored statements", "mtllib a.mtl\no object\ng group\nusemtl material\ns 1\n  # comment\n\t\n"
+                                "vn 0 0 1\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1//1 2//1 3//1\nl 1 2\n" },
+        { "zero index", "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 0\n" },
+    };
+    for (const Case& testCase : cases)
+    {
+        checkConformance(testCase.name, testCase.data);
+    }
+
+    std::string grid = makeGrid(400);
+    CHECK(grid.size() > 4 * 256 * 1024);
+    checkConformance("grid", grid);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string data = readFile(argv[i]);
+        CHECK(!data.empty());
+        checkConformance(argv[i], data);
+    }
+    std::printf("Compared %d files with tinyobj\n", argc - 1);
+
+    // tinyobj reads out of bounds for these, only check that they are rejected
+    ObjMesh mesh;
+    std::string error;
+    const char outOfRange[] = "v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n";
+    CHECK(!ObjParser::parse(outOfRange, sizeof(outOfRange) - 1, mesh, error));
+    CHECK(!error.empty());
+    const char relativeOutOfRange[] = "v 0 0 0\nv 1 0 0\nf -1 -2 -3\n";
+    CHECK(!ObjParser::parse(relativeOutOfRange, sizeof(relativeOutOfRange) - 1, mesh, error));
+
+    return testResult("ObjParserTest");
+}
@@ -0,0 +1,43 @@
+/*===============================================================================
+Copyright (c) 2020, PTC Inc. All rights reserved.
+
+Vuforia is a trademark of PTC Inc., registered in the United States and other
+countries.
+===============================================================================*/
+
+#ifndef __TEST_UTILS_H__
+#define __TEST_UTILS_H__
+
+#include <cstdio>
+
+/// Number of failed checks, main returns non-zero if any check failed
+inline int& testFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+/// Report a failed check with its location and count it
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++testFailures(); \
+        } \
+    } while (0)
+
+/// Print the result of a test run and return the process exit code
+inline int testResult(const char* name)
+{
+    if (testFailures() == 0)
+    {
+        std::printf("%s: all checks passed\n", name);
+        return 0;
+    }
+    std::printf("%s: %d checks failed\n", name, testFailures());
+    return 1;
+}
+
+#endif // __TEST_UTILS_H__
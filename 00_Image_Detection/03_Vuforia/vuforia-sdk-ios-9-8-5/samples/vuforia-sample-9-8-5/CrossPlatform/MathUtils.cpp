@@ -11,6 +11,118 @@ countries.
 #define _USE_MATH_DEFINES
 #include <cmath>
 
+// Define MATH_UTILS_NO_SIMD to build only the scalar kernels, e.g. as a baseline for benchmarks
+#if defined(MATH_UTILS_NO_SIMD)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MATH_UTILS_NEON
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MATH_UTILS_SSE
+#endif
+
+// Matrices are stored column by column (element (row, col) is data[col * 4 + row]),
+// so a matrix product is a linear combination of the columns of the left-hand matrix.
+// The SIMD kernels keep the summation order of the scalar ones, but the compiler may
+// contract the scalar code into fused multiply-adds, so results can differ in the last
+// bits between builds and paths. Compare results with a tolerance, not exactly.
+// Vuforia::Matrix44F has no alignment guarantee, hence the unaligned loads.
+namespace
+{
+#if !defined(MATH_UTILS_NEON) && !defined(MATH_UTILS_SSE)
+    /// Scalar reference for c = a * b, c may alias a or b
+    void multiply4x4Scalar(const float* a, const float* b, float* c)
+    {
+        float tmp[16];
+
+        for (int j = 0; j < 4; j++)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                tmp[j * 4 + i] = a[i] * b[j * 4] +
+                    a[4 + i] * b[j * 4 + 1] +
+                    a[8 + i] * b[j * 4 + 2] +
+                    a[12 + i] * b[j * 4 + 3];
+            }
+        }
+
+        for (int i = 0; i < 16; i++)
+            c[i] = tmp[i];
+    }
+
+    /// Scalar reference for r = m * v on a 4D vector, r may alias v
+    void transform4Scalar(const float* m, const float* v, float* r)
+    {
+        float tmp[4];
+
+        for (int i = 0; i < 4; i++)
+            tmp[i] = m[i] * v[0] + m[4 + i] * v[1] + m[8 + i] * v[2] + m[12 + i] * v[3];
+
+        for (int i = 0; i < 4; i++)
+            r[i] = tmp[i];
+    }
+#endif
+
+#if defined(MATH_UTILS_NEON)
+    inline float32x4_t combineColumns(float32x4_t a0, float32x4_t a1, float32x4_t a2, float32x4_t a3,
+                                      const float* b)
+    {
+        float32x4_t r = vmulq_n_f32(a0, b[0]);
+        r = vaddq_f32(r, vmulq_n_f32(a1, b[1]));
+        r = vaddq_f32(r, vmulq_n_f32(a2, b[2]));
+        return vaddq_f32(r, vmulq_n_f32(a3, b[3]));
+    }
+#elif defined(MATH_UTILS_SSE)
+    inline __m128 combineColumns(__m128 a0, __m128 a1, __m128 a2, __m128 a3, const float* b)
+    {
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(b[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(b[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(b[2])));
+        return _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(b[3])));
+    }
+#endif
+
+    /// c = a * b, c may alias a or b
+    inline void multiply4x4(const float* a, const float* b, float* c)
+    {
+#if defined(MATH_UTILS_NEON)
+        const float32x4_t a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4), a2 = vld1q_f32(a + 8), a3 = vld1q_f32(a + 12);
+        const float32x4_t c0 = combineColumns(a0, a1, a2, a3, b);
+        const float32x4_t c1 = combineColumns(a0, a1, a2, a3, b + 4);
+        const float32x4_t c2 = combineColumns(a0, a1, a2, a3, b + 8);
+        const float32x4_t c3 = combineColumns(a0, a1, a2, a3, b + 12);
+        vst1q_f32(c, c0);
+        vst1q_f32(c + 4, c1);
+        vst1q_f32(c + 8, c2);
+        vst1q_f32(c + 12, c3);
+#elif defined(MATH_UTILS_SSE)
+        const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+        const __m128 c0 = combineColumns(a0, a1, a2, a3, b);
+        const __m128 c1 = combineColumns(a0, a1, a2, a3, b + 4);
+        const __m128 c2 = combineColumns(a0, a1, a2, a3, b + 8);
+        const __m128 c3 = combineColumns(a0, a1, a2, a3, b + 12);
+        _mm_storeu_ps(c, c0);
+        _mm_storeu_ps(c + 4, c1);
+        _mm_storeu_ps(c + 8, c2);
+        _mm_storeu_ps(c + 12, c3);
+#else
+        multiply4x4Scalar(a, b, c);
+#endif
+    }
+
+    /// r = m * v on a 4D vector, r may alias v
+    inline void transform4(const float* m, const float* v, float* r)
+    {
+#if defined(MATH_UTILS_NEON)
+        vst1q_f32(r, combineColumns(vld1q_f32(m), vld1q_f32(m + 4), vld1q_f32(m + 8), vld1q_f32(m + 12), v));
+#elif defined(MATH_UTILS_SSE)
+        _mm_storeu_ps(r, combineColumns(_mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12), v));
+#else
+        transform4Scalar(m, v, r);
+#endif
+    }
+}
+
 Vuforia::Vec2F
 MathUtils::Vec2FZero()
 {
@@ -374,22 +486,7 @@ MathUtils::Vec4FTransform(const Vuforia::Matrix44F& m, const Vuforia::Vec4F& v)
 {
     Vuforia::Vec4F r;
 
-    r.data[0] = m.data[0] * v.data[0] +
-        m.data[4] * v.data[1] +
-        m.data[8] * v.data[2] +
-        m.data[12] * v.data[3];
-    r.data[1] = m.data[1] * v.data[0] +
-        m.data[5] * v.data[1] +
-        m.data[9] * v.data[2] +
-        m.data[13] * v.data[3];
-    r.data[2] = m.data[2] * v.data[0] +
-        m.data[6] * v.data[1] +
-        m.data[10] * v.data[2] +
-        m.data[14] * v.data[3];
-    r.data[3] = m.data[3] * v.data[0] +
-        m.data[7] * v.data[1] +
-        m.data[11] * v.data[2] +
-        m.data[15] * v.data[3];
+    transform4(m.data, v.data, r.data);
 
     return r;
 }
@@ -869,23 +966,69 @@ MathUtils::scaleMatrix(const Vuforia::Vec3F& scale, Vuforia::Matrix44F & m)
 void
 MathUtils::multiplyMatrix(const Vuforia::Matrix44F& matrixA, const Vuforia::Matrix44F& matrixB, Vuforia::Matrix44F& matrixC)
 {
-    int i, j, k;
-    Vuforia::Matrix44F aTmp;
-
     // matrixC= matrixA * matrixB
-    for (i = 0; i < 4; i++)
-    {
-        for (j = 0; j < 4; j++)
-        {
-            aTmp.data[j * 4 + i] = 0.0;
+    multiply4x4(matrixA.data, matrixB.data, matrixC.data);
+}
 
-            for (k = 0; k < 4; k++)
-                aTmp.data[j * 4 + i] += matrixA.data[k * 4 + i] * matrixB.data[j * 4 + k];
-        }
+
+void
+MathUtils::multiplyMatrices(const Vuforia::Matrix44F& matrixA, const Vuforia::Matrix44F* matricesB,
+                            Vuforia::Matrix44F* matricesC, int count)
+{
+    // matrixA may be one of matricesC, every path uses its value from before the first product
+    const Vuforia::Matrix44F a = matrixA;
+#if defined(MATH_UTILS_NEON)
+    const float32x4_t a0 = vld1q_f32(a.data), a1 = vld1q_f32(a.data + 4),
+        a2 = vld1q_f32(a.data + 8), a3 = vld1q_f32(a.data + 12);
+#elif defined(MATH_UTILS_SSE)
+    const __m128 a0 = _mm_loadu_ps(a.data), a1 = _mm_loadu_ps(a.data + 4),
+        a2 = _mm_loadu_ps(a.data + 8), a3 = _mm_loadu_ps(a.data + 12);
+#endif
+
+    for (int n = 0; n < count; n++)
+    {
+        const float* b = matricesB[n].data;
+        float* c = matricesC[n].data;
+#if defined(MATH_UTILS_NEON)
+        const float32x4_t c0 = combineColumns(a0, a1, a2, a3, b);
+        const float32x4_t c1 = combineColumns(a0, a1, a2, a3, b + 4);
+        const float32x4_t c2 = combineColumns(a0, a1, a2, a3, b + 8);
+        const float32x4_t c3 = combineColumns(a0, a1, a2, a3, b + 12);
+        vst1q_f32(c, c0);
+        vst1q_f32(c + 4, c1);
+        vst1q_f32(c + 8, c2);
+        vst1q_f32(c + 12, c3);
+#elif defined(MATH_UTILS_SSE)
+        const __m128 c0 = combineColumns(a0, a1, a2, a3, b);
+        const __m128 c1 = combineColumns(a0, a1, a2, a3, b + 4);
+        const __m128 c2 = combineColumns(a0, a1, a2, a3, b + 8);
+        const __m128 c3 = combineColumns(a0, a1, a2, a3, b + 12);
+        _mm_storeu_ps(c, c0);
+        _mm_storeu_ps(c + 4, c1);
+        _mm_storeu_ps(c + 8, c2);
+        _mm_storeu_ps(c + 12, c3);
+#else
+        multiply4x4Scalar(a.data, b, c);
+#endif
     }
+}
 
-    for (i = 0; i < 16; i++)
-        matrixC.data[i] = aTmp.data[i];
+
+void
+MathUtils::transformPoints(const Vuforia::Matrix44F& m, const Vuforia::Vec3F* points,
+                           Vuforia::Vec3F* result, int count)
+{
+    for (int n = 0; n < count; n++)
+    {
+        // consider each point as 4d vector with w=1.0
+        float v[4] = { points[n].data[0], points[n].data[1], points[n].data[2], 1.0f };
+        float r[4];
+        transform4(m.data, v, r);
+
+        result[n].data[0] = r[0];
+        result[n].data[1] = r[1];
+        result[n].data[2] = r[2];
+    }
 }
 
 
@@ -203,6 +203,14 @@ public:
     /// Multiply the two matrices A and B and writes the result to C (C = mA*mB)
     static void multiplyMatrix(const Vuforia::Matrix44F& mA, const Vuforia::Matrix44F& mB, Vuforia::Matrix44F& mC);
 
+    /// Multiply the matrix A with each of count matrices B and writes the results to C (C[i] = mA*mB[i])
+    /// C may point to the same array as B, and A may be one of the matrices of C
+    static void multiplyMatrices(const Vuforia::Matrix44F& mA, const Vuforia::Matrix44F* mB, Vuforia::Matrix44F* mC, int count);
+
+    /// Transform count 3D points by a 4x4 matrix and writes the results to result (pre multiply, result[i] = m * points[i])
+    /// result may point to the same array as points
+    static void transformPoints(const Vuforia::Matrix44F& m, const Vuforia::Vec3F* points, Vuforia::Vec3F* result, int count);
+
     /// Use the matrix to project the extents of the video background to the viewport
     /// This will generate normalized coordinates (i.e. full viewport has -1,+1 range)
     /// to create a rectangle that can be used to set a scissor on the video background